@@ -0,0 +1,733 @@
+// oliver_bench.cpp : Micro and macro benchmarks of the interpreter.
+//
+
+#include "oliver_bench.h"
+
+/*
+    Usage: oliver_bench [--filter TEXT] [--quick] [--corpus DIR]
+                        [--out FILE] [--compare BASELINE] [--threshold PCT]
+
+    Each benchmark is run for long enough to be timed, then timed
+    SAMPLES times, and the median time of one operation is kept.
+    The results are written as JSON, one benchmark to a line:
+
+        {"benchmarks":[
+        {"name":"let/copy","group":"micro","size":1,"iterations":N,"ns_per_op":T,"mb_per_s":R},
+        ...
+        ]}
+
+    'mb_per_s' is zero for benchmarks which do not read text.  With
+    '--compare' the results are checked against those of a saved run,
+    and any benchmark slower by more than the threshold is reported
+    as a regression, and the exit status is 1.
+*/
+
+#ifndef OLIVER_BENCH_CORPUS
+#define OLIVER_BENCH_CORPUS "corpus"
+#endif
+
+namespace {
+
+    using Olly::let;
+    using Olly::size_type;
+    using Olly::str_type;
+
+    typedef     std::chrono::steady_clock   clock_type;
+
+    const size_type  SAMPLES     = 5;
+    const size_type  SIZES[]     = { 16, 256, 4096 };
+    const size_type  MAP_SIZES[] = { 16, 64, 256 };     // Building a map takes more than quadratic time.
+
+    volatile size_type sink = 0;    // Results are written here, so that the work is not optimized away.
+
+    struct result {
+        str_type    name;
+        str_type    group;
+        size_type   size;
+        size_type   iterations;
+        double      ns_per_op;
+        double      mb_per_s;
+    };
+
+    struct settings {
+        str_type                    filter;
+        std::chrono::nanoseconds    min_time;
+        str_type                    corpus;
+        str_type                    out;
+        str_type                    compare;
+        double                      threshold;
+    };
+
+    class null_buffer : public std::streambuf {
+        /*
+            Swallow the output of the programs run.
+        */
+    protected:
+        int_type overflow(int_type c) override {
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char*, std::streamsize n) override {
+            return n;
+        }
+    };
+
+    class bench {
+
+        settings                _settings;
+        std::vector<result>     _results;
+
+    public:
+
+        bench(const settings& s) : _settings(s), _results() {
+        }
+
+        const std::vector<result>& results() const {
+            return _results;
+        }
+
+        void run(const str_type& name, const str_type& group, size_type size, size_type bytes_per_op, const std::function<void(size_type)>& body) {
+            /*
+                Double the iterations until a sample takes at least
+                the minimum time, then keep the median of the samples.
+            */
+
+            if (!_settings.filter.empty() && name.find(_settings.filter) == str_type::npos) {
+                return;
+            }
+
+            size_type iterations = 1;
+
+            while (time(body, iterations) < _settings.min_time && iterations < (size_type(1) << 40)) {
+                iterations *= 2;
+            }
+
+            std::vector<double> samples;
+
+            for (size_type i = 0; i < SAMPLES; ++i) {
+                samples.push_back(static_cast<double>(time(body, iterations).count()) / iterations);
+            }
+
+            std::sort(samples.begin(), samples.end());
+
+            double ns = samples[SAMPLES / 2];
+
+            double rate = bytes_per_op && ns > 0 ? bytes_per_op / ns * 1000 : 0;
+
+            _results.push_back(result{ name, group, size, iterations, ns, rate });
+
+            std::cerr << std::left << std::setw(36) << name << std::right << std::setw(14) << std::fixed << std::setprecision(1) << ns << " ns";
+
+            if (rate) {
+                std::cerr << std::setw(12) << rate << " MB/s";
+            }
+
+            std::cerr << std::endl;
+        }
+
+    private:
+
+        static std::chrono::nanoseconds time(const std::function<void(size_type)>& body, size_type iterations) {
+
+            auto start = clock_type::now();
+
+            body(iterations);
+
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start);
+        }
+    };
+
+    let build_expression(size_type n) {
+
+        let e = Olly::expression();
+
+        for (size_type i = 0; i < n; ++i) {
+            e = e.place_lead(Olly::number(i));
+        }
+
+        return e;
+    }
+
+    let build_list(size_type n) {
+
+        let l = Olly::list();
+
+        for (size_type i = 0; i < n; ++i) {
+            l = l.place_last(Olly::number(i));
+        }
+
+        return l;
+    }
+
+    let build_map(size_type n) {
+
+        let m = Olly::map();
+
+        for (size_type i = 0; i < n; ++i) {
+            m = m.set(Olly::number(i), Olly::number(i));
+        }
+
+        return m;
+    }
+
+    let compile(const str_type& source) {
+
+        Olly::parser lex(source);
+
+        Olly::compiler comp(lex.parse());
+
+        Olly::optimizer opt;
+
+        return opt.optimize(comp.compile());
+    }
+
+    str_type generate_source(size_type statements) {
+        /*
+            A program of simple statements of every kind of token,
+            for reading and compiling.
+        */
+
+        Olly::stream_type out;
+
+        for (size_type i = 0; i < statements; ++i) {
+            out << "let x" << i << " = '" << i << "' x" << i << " + '2' * \"s\" [ '1' '2' ] DROP # a comment\n";
+        }
+
+        return out.str();
+    }
+
+    void micro_let(bench& b) {
+
+        b.run("let/construct", "micro", 1, 0, [](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+                let x = Olly::number(i);
+                sink = sink + x.is();
+            }
+        });
+
+        let x = Olly::number(size_type(3));
+
+        b.run("let/copy", "micro", 1, 0, [&x](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+                let y = x;
+                sink = sink + y.is();
+            }
+        });
+
+        b.run("let/cast", "micro", 1, 0, [&x](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+                sink = sink + (x.cast<Olly::number>() != nullptr);
+            }
+        });
+
+        b.run("let/cast_miss", "micro", 1, 0, [&x](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+                sink = sink + (x.cast<Olly::string>() != nullptr);
+            }
+        });
+    }
+
+    void micro_collections(bench& b) {
+        /*
+            The time of an operation over every element of a
+            collection, for collections of each size.
+        */
+
+        for (size_type size : SIZES) {
+
+            str_type s = "/" + std::to_string(size);
+
+            b.run("expression/place_lead" + s, "micro", size, 0, [size](size_type n) {
+                for (size_type i = 0; i < n; ++i) {
+                    sink = sink + build_expression(size).size();
+                }
+            });
+
+            let e = build_expression(size);
+
+            b.run("expression/drop_lead" + s, "micro", size, 0, [&e](size_type n) {
+                for (size_type i = 0; i < n; ++i) {
+                    for (let x = e; x.is(); x = x.drop_lead()) {
+                        sink = sink + x.lead().is();
+                    }
+                }
+            });
+
+            b.run("expression/reverse" + s, "micro", size, 0, [&e](size_type n) {
+                for (size_type i = 0; i < n; ++i) {
+                    sink = sink + e.reverse().size();
+                }
+            });
+
+            b.run("list/place_last" + s, "micro", size, 0, [size](size_type n) {
+                for (size_type i = 0; i < n; ++i) {
+                    sink = sink + build_list(size).size();
+                }
+            });
+
+            let l = build_list(size);
+
+            b.run("list/drop_lead" + s, "micro", size, 0, [&l](size_type n) {
+                for (size_type i = 0; i < n; ++i) {
+                    for (let x = l; x.is(); x = x.drop_lead()) {
+                        sink = sink + x.lead().is();
+                    }
+                }
+            });
+        }
+
+        for (size_type size : MAP_SIZES) {
+
+            str_type s = "/" + std::to_string(size);
+
+            b.run("map/set" + s, "micro", size, 0, [size](size_type n) {
+                for (size_type i = 0; i < n; ++i) {
+                    sink = sink + build_map(size).size();
+                }
+            });
+
+            let m = build_map(size);
+
+            std::vector<let> keys;
+
+            for (size_type i = 0; i < size; ++i) {
+                keys.push_back(Olly::number(i));
+            }
+
+            b.run("map/get" + s, "micro", size, 0, [&m, &keys](size_type n) {
+                for (size_type i = 0; i < n; ++i) {
+                    for (const let& k : keys) {
+                        sink = sink + m.get(k).is();
+                    }
+                }
+            });
+        }
+    }
+
+    void micro_number(bench& b) {
+
+        let x = Olly::number(Olly::real_type(12345.678));
+        let y = Olly::number(Olly::real_type(3.25));
+
+        b.run("number/add", "micro", 1, 0, [&](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+                sink = sink + x.add(y).is();
+            }
+        });
+
+        b.run("number/mul", "micro", 1, 0, [&](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+                sink = sink + x.mul(y).is();
+            }
+        });
+
+        b.run("number/div", "micro", 1, 0, [&](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+                sink = sink + x.div(y).is();
+            }
+        });
+
+        b.run("number/comp", "micro", 1, 0, [&](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+                sink = sink + x.lt(y);
+            }
+        });
+    }
+
+    void micro_operators(bench& b) {
+        /*
+            Looking up the words of a program as operators, in
+            the compile time table, against a map of the names
+            built at start up and searched in lower and then
+            upper case as the compiler once did.
+        */
+
+        const std::vector<str_type> words = {
+            "let", "x", "=", "'1'", "+", "EMIT", "Emit", "func", "MAP", "map",
+            "DROP", "drop_lead", "-->", "counter", "total", "FOLD", "neg", "ENDL"
+        };
+
+        b.run("operators/table", "micro", words.size(), 0, [&words](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+                for (const str_type& w : words) {
+                    sink = sink + (Olly::OPERATORS.find(w) != nullptr);
+                }
+            }
+        });
+
+        std::map<str_type, Olly::OP_CODE, std::less<>> names;
+
+        for (const Olly::operator_name& n : Olly::OPERATOR_NAMES) {
+            names.emplace(n.name, n.code);
+        }
+
+        b.run("operators/map", "micro", words.size(), 0, [&words, &names](size_type n) {
+
+            str_type folded;
+
+            for (size_type i = 0; i < n; ++i) {
+                for (const str_type& w : words) {
+
+                    auto it = names.find(w);
+
+                    if (it == names.end() || !(it->second > Olly::OP_CODE::SUPER_OPERATORS && it->second < Olly::OP_CODE::COLLECTION_OPERATORS)) {
+                        Olly::assign_lower(folded, w);
+                        it = names.find(folded);
+                    }
+
+                    if (it == names.end()) {
+                        Olly::assign_upper(folded, w);
+                        it = names.find(folded);
+                    }
+
+                    sink = sink + (it != names.end());
+                }
+            }
+        });
+
+        b.run("operators/map_build", "micro", std::size(Olly::OPERATOR_NAMES), 0, [](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+
+                std::map<str_type, Olly::OP_CODE, std::less<>> m;
+
+                for (const Olly::operator_name& name : Olly::OPERATOR_NAMES) {
+                    m.emplace(name.name, name.code);
+                }
+
+                sink = sink + m.size();
+            }
+        });
+    }
+
+    void micro_parse(bench& b) {
+        /*
+            Reading and compiling throughput, in bytes of source.
+            A program is compiled from all its tokens, or as they
+            are read, or as they are read on another thread.
+        */
+
+        for (size_type size : SIZES) {
+
+            str_type s      = "/" + std::to_string(size);
+            str_type source = generate_source(size);
+
+            b.run("parse" + s, "micro", size, source.size(), [&source](size_type n) {
+                for (size_type i = 0; i < n; ++i) {
+                    Olly::parser lex(source);
+                    sink = sink + lex.parse().size();
+                }
+            });
+
+            b.run("compile" + s, "micro", size, source.size(), [&source](size_type n) {
+                for (size_type i = 0; i < n; ++i) {
+                    sink = sink + compile(source).size();
+                }
+            });
+
+            b.run("compile_stream" + s, "micro", size, source.size(), [&source](size_type n) {
+                for (size_type i = 0; i < n; ++i) {
+
+                    Olly::parser    lex(source);
+                    Olly::compiler  comp(lex);
+                    Olly::optimizer opt;
+
+                    sink = sink + opt.optimize(comp.compile()).size();
+                }
+            });
+
+            b.run("compile_thread" + s, "micro", size, source.size(), [&source](size_type n) {
+                for (size_type i = 0; i < n; ++i) {
+
+                    Olly::parser     lex(source);
+                    Olly::token_pipe pipe(lex);
+                    Olly::compiler   comp(pipe);
+                    Olly::optimizer  opt;
+
+                    sink = sink + opt.optimize(comp.compile()).size();
+                }
+            });
+        }
+    }
+
+    void micro_read(bench& b) {
+        /*
+            Reading throughput of a large source file, mapped in
+            to memory, against the same text read from a stream
+            and from a string.
+        */
+
+        const size_type statements = 65536;
+
+        str_type s      = "/" + std::to_string(statements);
+        str_type source = generate_source(statements);
+
+        std::filesystem::path path = std::filesystem::temp_directory_path() / "oliver_bench_read.olly";
+
+        {
+            std::ofstream out(path, std::ios::out | std::ios::binary);
+            out << source;
+        }
+
+        str_type file = path.string();
+
+        b.run("read/file" + s, "micro", statements, source.size(), [&file](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+
+                Olly::text_reader text(file);
+
+                size_type sum = 0;
+
+                while (text.is()) {
+                    sum += static_cast<unsigned char>(text.next());
+                }
+
+                sink = sink + sum;
+            }
+        });
+
+        b.run("read/stream" + s, "micro", statements, source.size(), [&file](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+
+                std::ifstream text(file);
+
+                size_type sum = 0;
+                char      c;
+
+                while (text >> std::noskipws >> c) {
+                    sum += static_cast<unsigned char>(c);
+                }
+
+                sink = sink + sum;
+            }
+        });
+
+        b.run("read/text" + s, "micro", statements, source.size(), [&source](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+
+                Olly::text_reader text(source);
+
+                size_type sum = 0;
+
+                while (text.is()) {
+                    sum += static_cast<unsigned char>(text.next());
+                }
+
+                sink = sink + sum;
+            }
+        });
+
+        b.run("read/parse_file" + s, "micro", statements, source.size(), [&file](size_type n) {
+            for (size_type i = 0; i < n; ++i) {
+                Olly::parser lex(file);
+                sink = sink + lex.parse().size();
+            }
+        });
+
+        std::error_code error;
+
+        std::filesystem::remove(path, error);
+    }
+
+    void macro_corpus(bench& b, const str_type& corpus) {
+        /*
+            Load and run each script of the corpus, whole.  The
+            scripts' output is discarded.
+        */
+
+        std::error_code error;
+
+        std::vector<std::filesystem::path> scripts;
+
+        for (const auto& entry : std::filesystem::directory_iterator(corpus, error)) {
+
+            if (entry.path().extension() == ".olly") {
+                scripts.push_back(entry.path());
+            }
+        }
+
+        if (error) {
+            std::cerr << "Unable to read the corpus " << corpus << ": " << error.message() << std::endl;
+            return;
+        }
+
+        std::sort(scripts.begin(), scripts.end());
+
+        null_buffer discard;
+
+        std::streambuf* out = std::cout.rdbuf(&discard);
+
+        for (const auto& path : scripts) {
+
+            str_type file = path.string();
+
+            size_type bytes = static_cast<size_type>(std::filesystem::file_size(path, error));
+
+            b.run("script/" + path.stem().string(), "macro", 1, bytes, [&file](size_type n) {
+                for (size_type i = 0; i < n; ++i) {
+
+                    Olly::eval::evaluator olly;
+
+                    sink = sink + olly.eval(compile(file)).is();
+                }
+            });
+        }
+
+        std::cout.rdbuf(out);
+    }
+
+    void write_json(std::ostream& out, const std::vector<result>& results) {
+
+        out << "{\"benchmarks\":[" << std::endl;
+
+        for (size_type i = 0; i < results.size(); ++i) {
+
+            const result& r = results[i];
+
+            out << "{\"name\":\"" << r.name << "\",\"group\":\"" << r.group << "\",\"size\":" << r.size
+                << ",\"iterations\":" << r.iterations << std::fixed << std::setprecision(3)
+                << ",\"ns_per_op\":" << r.ns_per_op << ",\"mb_per_s\":" << r.mb_per_s << "}"
+                << (i + 1 < results.size() ? "," : "") << std::endl;
+        }
+
+        out << "]}" << std::endl;
+    }
+
+    str_type field(const str_type& line, const str_type& key) {
+        /*
+            The text of a field of a line written by 'write_json'.
+        */
+
+        str_type tag = "\"" + key + "\":";
+
+        size_type pos = line.find(tag);
+
+        if (pos == str_type::npos) {
+            return "";
+        }
+
+        pos += tag.size();
+
+        if (pos < line.size() && line[pos] == '"') {
+            return line.substr(pos + 1, line.find('"', pos + 1) - pos - 1);
+        }
+
+        return line.substr(pos, line.find_first_of(",}", pos) - pos);
+    }
+
+    bool compare(const str_type& baseline, const std::vector<result>& results, double threshold) {
+        /*
+            Report the change of each benchmark from the baseline.
+            Return false if any is slower by more than 'threshold'
+            percent.
+        */
+
+        std::ifstream in(baseline);
+
+        if (!in) {
+            std::cerr << "Unable to read the baseline " << baseline << std::endl;
+            return false;
+        }
+
+        std::map<str_type, double> before;
+
+        for (str_type line; std::getline(in, line);) {
+
+            str_type name = field(line, "name");
+            str_type ns   = field(line, "ns_per_op");
+
+            if (!name.empty() && !ns.empty()) {
+                before[name] = std::stod(ns);
+            }
+        }
+
+        bool passed = true;
+
+        std::cerr << std::endl << std::left << std::setw(36) << "benchmark" << std::right
+                  << std::setw(14) << "baseline ns" << std::setw(14) << "current ns" << std::setw(10) << "change" << std::endl;
+
+        for (const result& r : results) {
+
+            auto itr = before.find(r.name);
+
+            if (itr == before.end() || itr->second <= 0) {
+                continue;
+            }
+
+            double change = (r.ns_per_op - itr->second) / itr->second * 100;
+
+            bool regressed = change > threshold;
+
+            std::cerr << std::left << std::setw(36) << r.name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(14) << itr->second << std::setw(14) << r.ns_per_op << std::setw(9) << change << "%"
+                      << (regressed ? "  REGRESSION" : "") << std::endl;
+
+            passed = passed && !regressed;
+        }
+
+        return passed;
+    }
+
+} // end anonymous
+
+int main(int argc, char** argv) {
+
+    try {
+        settings s{ "", std::chrono::milliseconds(100), OLIVER_BENCH_CORPUS, "", "", 10.0 };
+
+        for (int i = 1; i < argc; ++i) {
+
+            str_type arg = argv[i];
+
+            if (arg == "--filter" && i + 1 < argc) {
+                s.filter = argv[++i];
+            }
+            else if (arg == "--quick") {
+                s.min_time = std::chrono::milliseconds(1);
+            }
+            else if (arg == "--corpus" && i + 1 < argc) {
+                s.corpus = argv[++i];
+            }
+            else if (arg == "--out" && i + 1 < argc) {
+                s.out = argv[++i];
+            }
+            else if (arg == "--compare" && i + 1 < argc) {
+                s.compare = argv[++i];
+            }
+            else if (arg == "--threshold" && i + 1 < argc) {
+                s.threshold = std::stod(argv[++i]);
+            }
+            else {
+                std::cerr << "Usage: oliver_bench [--filter TEXT] [--quick] [--corpus DIR] [--out FILE] [--compare BASELINE] [--threshold PCT]" << std::endl;
+                return 2;
+            }
+        }
+
+        bench b(s);
+
+        micro_let(b);
+        micro_collections(b);
+        micro_number(b);
+        micro_operators(b);
+        micro_parse(b);
+        micro_read(b);
+        macro_corpus(b, s.corpus);
+
+        if (s.out.empty()) {
+            write_json(std::cout, b.results());
+        }
+        else {
+            std::ofstream out(s.out);
+            write_json(out, b.results());
+        }
+
+        if (!s.compare.empty() && !compare(s.compare, b.results(), s.threshold)) {
+            return 1;
+        }
+    }
+    catch (std::exception& e) {
+        std::cerr << "Error during benchmark: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
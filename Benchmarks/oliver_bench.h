@@ -0,0 +1,15 @@
+#ifndef OLIVER_BENCH_H	// oliver_bench.h : Include file for the benchmark suite.
+#define OLIVER_BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+#include "../Oliver_Lang/Olliver.h"
+
+#endif // OLIVER_BENCH_H
@@ -5,42 +5,489 @@
 
 using namespace std;
 
+/*
+    Heap allocations are counted, so that '--steady' can show
+    a program run again allocates nothing.  Define
+    OLIVER_COUNT_ALLOCATIONS as 0 to leave operator new alone.
+*/
+
+#ifndef OLIVER_COUNT_ALLOCATIONS
+#define OLIVER_COUNT_ALLOCATIONS 1
+#endif
+
+static std::atomic<Olly::size_type> allocations(0);
+
+#if OLIVER_COUNT_ALLOCATIONS
+
+void* operator new(std::size_t size) {
+
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    void* p = std::malloc(size ? size : 1);
+
+    if (!p) {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t size) noexcept {
+    std::free(p);
+}
+
+#endif
+
+struct trace_file {
+    /*
+        Write the spans traced to a file once the program,
+        and any threads it started, have ended.
+    */
+
+    Olly::str_type path;
+
+    ~trace_file() {
+
+        if (!path.empty()) {
+
+            Olly::file_writer f(path);
+
+            f.write(Olly::tracer::json());
+        }
+    }
+};
+
+struct token_dump : public Olly::token_source {
+    /*
+        Pass on the tokens of a source, writing each
+        to a file as it goes by.
+    */
+
+    Olly::token_source&                 source;
+    std::unique_ptr<Olly::file_writer>  file;
+
+    token_dump(Olly::token_source& s, const Olly::str_type& path) : source(s), file() {
+
+        if (!path.empty()) {
+            file = std::make_unique<Olly::file_writer>(path);
+        }
+    }
+
+    Olly::bool_type next(Olly::token& t) override {
+
+        if (!source.next(t)) {
+            return false;
+        }
+
+        if (file) {
+            file->write_line(Olly::spelling(t));
+        }
+
+        return true;
+    }
+};
+
+static void run_steady(const Olly::let& code, Olly::size_type runs, const Olly::eval::evaluator::limits& limits) {
+    /*
+        Run a program in one preallocated evaluator, first to
+        warm it up, then 'runs' times, counting the allocations
+        made and the latency of each run.
+    */
+
+    const Olly::size_type WARM_UP = 64;   // Enough runs for a lambda called once a run to be compiled.
+
+    Olly::eval::evaluator olly;
+
+    olly.set_limits(limits);
+    olly.preallocate(Olly::eval::evaluator::DEFAULT_CAPACITY);
+    olly.enable_stats();
+
+    for (Olly::size_type i = 0; i < WARM_UP; ++i) {
+
+        olly.eval(code);
+        olly.flush_output();
+        olly.reset();
+    }
+
+    olly.clear_stats();
+
+    Olly::size_type before = allocations.load();
+
+    for (Olly::size_type i = 0; i < runs; ++i) {
+
+        olly.eval(code);
+
+        olly.flush_output();
+        olly.reset();
+    }
+
+    Olly::size_type made = allocations.load() - before;
+
+    std::cout.flush();
+
+    std::cerr << std::endl << "steady: " << made << " allocations in " << runs << " runs" << std::endl;
+    std::cerr << "latency: " << olly.stats().latency.report("ns") << std::endl;
+}
+
+static void print_usage() {
+
+    std::cout
+        << "Usage: Oliver <program text or file> [options]\n"
+        << "\n"
+        << "    --opt-report              Report the optimizations made.\n"
+        << "    --opcode-stats            Report the operators run.\n"
+        << "    --memo-stats              Report the hits and misses of memoized calls.\n"
+        << "    --jit-stats               Report the lambda bodies compiled and evicted.\n"
+        << "    --eval-stats              Report the latency of each evaluation.\n"
+        << "    --let-stats               Report the objects made by each operator.\n"
+        << "    --profile                 Report the time spent in each operator and call.\n"
+        << "    --profile-stacks <file>   Write the sampled call stacks.\n"
+        << "    --trace <file>            Write a trace of the run.\n"
+        << "    --trace-calls             Trace each call in the trace.\n"
+        << "    --heap-snapshot <file>    Write the values held once the program has run.\n"
+        << "    --dump-tokens <file>      Write the tokens of the program.\n"
+        << "    --parse-thread            Read the program on a thread of its own.\n"
+        << "    --repeat <number>         Run the program a number of times.\n"
+        << "    --steady <number>         Count the allocations of a number of runs once warmed.\n"
+        << "    --slice <number>          Run the program in slices of operators.\n"
+        << "    --max-ops <number>        Preempt after a number of operators.\n"
+        << "    --deadline-us <number>    Preempt after a number of microseconds.\n"
+        << "    --max-bytes <number>      Preempt after a number of bytes are made.\n"
+        << "    --resume                  Resume a preempted program until it ends.\n"
+        << "    --pool <number>           Run each repeat on a pool of a number of evaluators.\n"
+        << "    --threads <number>        Size the shared thread pool.\n";
+}
+
 int main(Olly::int_type argc, char** argv) {
 	
     try {
         if (argc == 1) {
+            print_usage();
             return 0;
         }
 
-        if (argc == 2) {
+        Olly::str_type  input;
+        Olly::bool_type opt_report   = false;
+        Olly::bool_type opcode_stats = false;
+        Olly::bool_type memo_stats   = false;
+        Olly::bool_type jit_stats    = false;
+        Olly::bool_type eval_stats   = false;
+        Olly::str_type  dump_tokens;
+        Olly::bool_type parse_thread = false;
+        Olly::bool_type profile      = false;
+        Olly::bool_type let_stats    = false;
+        Olly::str_type  trace;
+        Olly::bool_type trace_calls  = false;
+        Olly::str_type  profile_stacks;
+        Olly::str_type  heap_snapshot;
+        Olly::size_type repeat       = 1;
+        Olly::size_type pool         = 0;
+        Olly::size_type slice        = 0;
+        Olly::size_type steady       = 0;
+        Olly::bool_type resume       = false;
+
+        Olly::eval::evaluator::limits limits{ 0, std::chrono::nanoseconds(0), 0 };
+
+        for (Olly::int_type i = 1; i < argc; ++i) {
+
+            Olly::str_type arg = argv[i];
+
+            if (arg == "--opt-report") {
+                opt_report = true;
+            }
+            else if (arg == "--opcode-stats") {
+                opcode_stats = true;
+            }
+            else if (arg == "--memo-stats") {
+                memo_stats = true;
+            }
+            else if (arg == "--jit-stats") {
+                jit_stats = true;
+            }
+            else if (arg == "--eval-stats") {
+                eval_stats = true;
+            }
+            else if (arg == "--trace" && i + 1 < argc) {
+                trace = argv[++i];
+            }
+            else if (arg == "--trace-calls") {
+                trace_calls = true;
+            }
+            else if (arg == "--let-stats") {
+                let_stats = true;
+            }
+            else if (arg == "--profile") {
+                profile = true;
+            }
+            else if (arg == "--profile-stacks" && i + 1 < argc) {
+                profile_stacks = argv[++i];
+            }
+            else if (arg == "--heap-snapshot" && i + 1 < argc) {
+                heap_snapshot = argv[++i];
+            }
+            else if (arg == "--repeat" && i + 1 < argc) {
+                repeat = std::stoul(argv[++i]);
+            }
+            else if (arg == "--dump-tokens" && i + 1 < argc) {
+                dump_tokens = argv[++i];
+            }
+            else if (arg == "--parse-thread") {
+                parse_thread = true;
+            }
+            else if (arg == "--steady" && i + 1 < argc) {
+                steady = std::stoul(argv[++i]);
+            }
+            else if (arg == "--slice" && i + 1 < argc) {
+                slice = std::stoul(argv[++i]);
+            }
+            else if (arg == "--max-ops" && i + 1 < argc) {
+                limits.operations = std::stoul(argv[++i]);
+            }
+            else if (arg == "--deadline-us" && i + 1 < argc) {
+                limits.time = std::chrono::microseconds(std::stoul(argv[++i]));
+            }
+            else if (arg == "--max-bytes" && i + 1 < argc) {
+                limits.allocation = std::stoul(argv[++i]);
+            }
+            else if (arg == "--resume") {
+                resume = true;
+            }
+            else if (arg == "--pool" && i + 1 < argc) {
+                pool = std::stoul(argv[++i]);
+            }
+            else if (arg == "--threads" && i + 1 < argc) {
+                Olly::eval::thread_pool::set_shared_size(std::stoul(argv[++i]));
+            }
+            else {
+                input = arg;
+            }
+        }
+
+        if (!trace.empty()) {
+            Olly::tracer::enable(Olly::tracer::DEFAULT_CAPACITY, trace_calls);
+        }
+
+        trace_file traced{ trace };
+
+        if (!input.empty()) {
 
             Olly::let code;
 
             {
-                Olly::tokens_type code_tokens;
-
                 {
-                    Olly::parser lex(argv[1]);
-                    code_tokens = lex.parse();
+                    /*
+                        The program is compiled as it is read,
+                        on a thread of its own if asked.  The
+                        tokens view the parser's text, so are
+                        compiled while it is in scope.
+                    */
+
+                    Olly::parser lex(input);
+
+                    token_dump dumped(lex, dump_tokens);
 
-                    Olly::file_writer f("parsed_code.txt");
+                    std::unique_ptr<Olly::token_pipe> pipe;
 
-                    for (auto i : code_tokens) {
-                        f.write_line(i);
+                    Olly::token_source* source = &dumped;
+
+                    if (parse_thread) {
+                        pipe   = std::make_unique<Olly::token_pipe>(dumped);
+                        source = pipe.get();
                     }
+
+                    Olly::compiler comp(*source);
+                    code = comp.compile();
                 }
 
                 {
-                    Olly::compiler comp(code_tokens);
-                    code = comp.compile();
+                    Olly::optimizer opt;
+                    code = opt.optimize(code);
+
+                    if (opt_report) {
+                        std::cerr << opt.report() << std::endl;
+                    }
                 }
             }
 
             // Olly::print("input   = " + str(code));
 
-            {
+            if (steady) {
+                run_steady(code, steady, limits);
+                return 0;
+            }
+
+            if (pool) {
+                /*
+                    Run each repeat of the program as a job of an
+                    evaluator pool, all sharing the compiled code.
+                */
+
+                Olly::eval::evaluator_pool workers(pool);
+
+                std::vector<std::future<Olly::let>> results;
+
+                for (Olly::size_type i = 0; i < repeat; ++i) {
+                    results.push_back(workers.submit(code));
+                }
+
+                for (auto& r : results) {
+                    r.get();
+                }
+
+                return 0;
+            }
+
+            for (Olly::size_type i = 0; i < repeat; ++i) {
+
                 Olly::eval::evaluator olly;
-                code = olly.eval(code);
+
+                olly.set_limits(limits);
+
+                if (opcode_stats) {
+                    olly.collect_ngrams(3);
+                }
+
+                if (eval_stats) {
+                    olly.enable_stats();
+                }
+
+#if OLIVER_PROFILE
+                if (profile || !profile_stacks.empty()) {
+                    olly.enable_profiling();
+                }
+#endif
+
+                if (slice) {
+                    /*
+                        Run the program as a coroutine, resuming it
+                        after each slice of operators or output.
+                    */
+
+                    Olly::size_type budget = 0;
+                    Olly::size_type output = 0;
+
+                    Olly::eval::eval_task task = olly.eval_async(code, slice);
+
+                    while (task.resume()) {
+
+                        if (olly.yielded() == Olly::eval::evaluator::yield_type::output) {
+                            output += 1;
+                        }
+                        else {
+                            budget += 1;
+                        }
+                    }
+
+                    std::cerr << std::endl << "async: " << budget << " budget, " << output << " output suspensions" << std::endl;
+                }
+                else {
+                    /*
+                        An evaluation preempted by a limit reports
+                        the limit, and with '--resume' is continued
+                        until it completes.
+                    */
+
+                    Olly::let result = olly.eval(code);
+
+                    Olly::size_type preemptions = 0;
+
+                    while (olly.preempted()) {
+
+                        preemptions += 1;
+
+                        if (!resume) {
+                            std::cerr << std::endl << str(result) << std::endl;
+                            break;
+                        }
+
+                        result = olly.resume();
+                    }
+
+                    if (resume && preemptions) {
+                        std::cerr << std::endl << "limits: " << preemptions << " preemptions" << std::endl;
+                    }
+                }
+
+                if (opcode_stats) {
+                    std::cerr << olly.ngram_report(20);
+                }
+
+                if (eval_stats) {
+                    std::cerr << std::endl << olly.stats().report();
+                }
+
+                if (!heap_snapshot.empty()) {
+                    /*
+                        The values the evaluator holds once the run
+                        has ended, or has been preempted.
+                    */
+
+                    Olly::eval::heap_snapshot snap;
+
+                    olly.snapshot_heap(snap);
+
+                    std::cerr << std::endl << snap.report(10);
+
+                    Olly::file_writer f(heap_snapshot);
+
+                    f.write(snap.dump());
+                }
+
+                if (memo_stats) {
+                    std::cerr << "memo: " << olly.memo_hits() << " hits, " << olly.memo_misses() << " misses" << std::endl;
+                }
+
+                if (jit_stats) {
+                    std::cerr << "jit: " << olly.jit_compiled() << " compiled, " << olly.jit_evicted() << " evicted" << std::endl;
+                }
+
+                if (profile || !profile_stacks.empty()) {
+#if OLIVER_PROFILE
+                    if (profile) {
+                        std::cerr << std::endl << olly.profile().report(20);
+                    }
+
+                    if (!profile_stacks.empty()) {
+
+                        Olly::file_writer f(profile_stacks);
+
+                        f.write(olly.profile().collapsed());
+                    }
+#else
+                    std::cerr << "Profiling is not built in.  Configure with -DOLIVER_PROFILE=ON." << std::endl;
+#endif
+                }
+            }
+
+            if (let_stats) {
+                /*
+                    The objects made, released and copied by each
+                    data type, and the operators which made them.
+                */
+
+#if OLIVER_LET_STATS
+                std::cerr << std::endl << std::left << std::setw(16) << "type" << std::right
+                          << std::setw(12) << "made" << std::setw(12) << "released" << std::setw(12) << "live bytes" << std::setw(12) << "copies" << std::endl;
+
+                for (const auto& t : Olly::let_stats::types()) {
+                    std::cerr << std::left << std::setw(16) << t.name << std::right
+                              << std::setw(12) << t.allocations << std::setw(12) << t.frees << std::setw(12) << t.live_bytes << std::setw(12) << t.copies << std::endl;
+                }
+
+                std::cerr << std::endl << std::left << std::setw(16) << "operator" << std::right
+                          << std::setw(12) << "made" << std::setw(12) << "bytes" << std::setw(12) << "copies" << std::endl;
+
+                for (const auto& o : Olly::let_stats::operators()) {
+                    std::cerr << std::left << std::setw(16) << str(Olly::op_call(o.opr)) << std::right
+                              << std::setw(12) << o.allocations << std::setw(12) << o.bytes << std::setw(12) << o.copies << std::endl;
+                }
+#else
+                std::cerr << "Object counts are not built in.  Configure with -DOLIVER_LET_STATS=ON." << std::endl;
+#endif
             }
 
             // Olly::print("output  = " + str(code));
@@ -1,7 +1,12 @@
 ﻿#ifndef MAIN_H	// OliverLang.h : Include file for standard system include files,
 #define MAIN_H	// or project specific include files.
 
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <new>
 
 #include "../Oliver_Lang/Olliver.h"
 
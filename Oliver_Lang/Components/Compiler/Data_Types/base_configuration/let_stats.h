@@ -0,0 +1,260 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+/*
+    The counters are kept only when OLIVER_LET_STATS is defined as
+    1.  Else 'let' makes, copies and releases its objects without
+    counting them.
+*/
+
+#ifndef OLIVER_LET_STATS
+#define OLIVER_LET_STATS 0
+#endif
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "op_codes.h"
+
+namespace Olly {
+
+    /********************************************************************************************/
+    //
+    //                                'let_stats' class definition
+    //
+    //        The let_stats class counts the objects made and released by 'let' for
+    //        each data type, with their live bytes and the copies made of 'let's
+    //        holding them.  Objects made and copies taken are also counted against
+    //        the operator the running thread's evaluator is dispatching.  Counters
+    //        are shared by all threads, and are updated without ordering.
+    //
+    /********************************************************************************************/
+
+    class let_stats {
+    public:
+
+        static constexpr size_type TYPES = 32;      // The most data types counted apart.
+        static constexpr size_type OPS   = static_cast<size_type>(OP_CODE::END_OPERATORS_OP) + 1;
+
+        struct type_counts {
+            str_type        name;
+            size_type       allocations;
+            size_type       frees;
+            std::int64_t    live_bytes;
+            size_type       copies;
+        };
+
+        struct op_counts {
+            OP_CODE         opr;
+            size_type       allocations;
+            size_type       bytes;
+            size_type       copies;
+        };
+
+        /*
+            Attribute the objects made on this thread to an
+            operator, until the scope ends.
+        */
+
+        class op_scope {
+            OP_CODE _previous;
+        public:
+            op_scope(OP_CODE opr);
+            ~op_scope();
+        };
+
+        static size_type register_type(const str_type& name);
+
+        static void made(size_type type, size_type bytes);
+        static void freed(size_type type, size_type bytes);
+        static void copied(size_type type);
+
+        static std::vector<type_counts> types();
+        static std::vector<op_counts> operators();
+        static void clear();
+
+    private:
+
+        struct type_cell {
+            std::atomic<size_type>      allocations;
+            std::atomic<size_type>      frees;
+            std::atomic<std::int64_t>   live_bytes;
+            std::atomic<size_type>      copies;
+        };
+
+        struct op_cell {
+            std::atomic<size_type>      allocations;
+            std::atomic<size_type>      bytes;
+            std::atomic<size_type>      copies;
+        };
+
+        static std::array<type_cell, TYPES>     _types;
+        static std::array<op_cell, OPS>         _ops;
+        static std::array<str_type, TYPES>      _names;
+        static std::atomic<size_type>           _registered;
+        static std::mutex                       _mutex;
+
+        static thread_local OP_CODE             _current;
+    };
+
+
+
+    std::array<let_stats::type_cell, let_stats::TYPES>  let_stats::_types      = {};
+    std::array<let_stats::op_cell, let_stats::OPS>      let_stats::_ops        = {};
+    std::array<str_type, let_stats::TYPES>              let_stats::_names      = {};
+    std::atomic<size_type>                              let_stats::_registered(0);
+    std::mutex                                          let_stats::_mutex;
+
+    thread_local OP_CODE                                let_stats::_current    = OP_CODE::NOTHING_OP;
+
+    let_stats::op_scope::op_scope(OP_CODE opr) : _previous(_current) {
+        _current = opr;
+    }
+
+    let_stats::op_scope::~op_scope() {
+        _current = _previous;
+    }
+
+    inline size_type let_stats::register_type(const str_type& name) {
+        /*
+            Return the index of a data type's counters.  The types
+            beyond the last index share its counters.
+        */
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        size_type n = _registered.load(std::memory_order_relaxed);
+
+        for (size_type i = 0; i < n; ++i) {
+
+            if (_names[i] == name) {
+                return i;
+            }
+        }
+
+        if (n == TYPES) {
+            _names[TYPES - 1] = "other";
+            return TYPES - 1;
+        }
+
+        _names[n] = name;
+
+        _registered.store(n + 1, std::memory_order_release);
+
+        return n;
+    }
+
+    inline void let_stats::made(size_type type, size_type bytes) {
+
+        _types[type].allocations.fetch_add(1, std::memory_order_relaxed);
+        _types[type].live_bytes.fetch_add(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+
+        op_cell& op = _ops[static_cast<size_type>(_current)];
+
+        op.allocations.fetch_add(1, std::memory_order_relaxed);
+        op.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    inline void let_stats::freed(size_type type, size_type bytes) {
+
+        _types[type].frees.fetch_add(1, std::memory_order_relaxed);
+        _types[type].live_bytes.fetch_sub(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+    }
+
+    inline void let_stats::copied(size_type type) {
+
+        _types[type].copies.fetch_add(1, std::memory_order_relaxed);
+
+        _ops[static_cast<size_type>(_current)].copies.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline std::vector<let_stats::type_counts> let_stats::types() {
+
+        std::vector<type_counts> result;
+
+        size_type n = _registered.load(std::memory_order_acquire);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        for (size_type i = 0; i < n; ++i) {
+
+            const type_cell& c = _types[i];
+
+            result.push_back(type_counts{ _names[i],
+                c.allocations.load(std::memory_order_relaxed),
+                c.frees.load(std::memory_order_relaxed),
+                c.live_bytes.load(std::memory_order_relaxed),
+                c.copies.load(std::memory_order_relaxed) });
+        }
+
+        return result;
+    }
+
+    inline std::vector<let_stats::op_counts> let_stats::operators() {
+        /*
+            The operators which made or copied any object.  The
+            work done outside of any operator, such as placing
+            values on to the stack and calling lambdas, is counted
+            against NOTHING_OP.
+        */
+
+        std::vector<op_counts> result;
+
+        for (size_type i = 0; i < OPS; ++i) {
+
+            const op_cell& c = _ops[i];
+
+            op_counts counts{ static_cast<OP_CODE>(i),
+                c.allocations.load(std::memory_order_relaxed),
+                c.bytes.load(std::memory_order_relaxed),
+                c.copies.load(std::memory_order_relaxed) };
+
+            if (counts.allocations || counts.copies) {
+                result.push_back(counts);
+            }
+        }
+
+        return result;
+    }
+
+    inline void let_stats::clear() {
+        /*
+            Live bytes are kept, as the objects they count are.
+        */
+
+        for (auto& c : _types) {
+            c.allocations.store(0, std::memory_order_relaxed);
+            c.frees.store(0, std::memory_order_relaxed);
+            c.copies.store(0, std::memory_order_relaxed);
+        }
+
+        for (auto& c : _ops) {
+            c.allocations.store(0, std::memory_order_relaxed);
+            c.bytes.store(0, std::memory_order_relaxed);
+            c.copies.store(0, std::memory_order_relaxed);
+        }
+    }
+
+} // end Olly
@@ -0,0 +1,240 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include <cstddef>
+#include <new>
+
+namespace Olly {
+
+    /********************************************************************************************/
+    //
+    //                                'object_pool' class definition
+    //
+    //        The object_pool class keeps the blocks of released objects, by size, on
+    //        free lists of the thread which released them.  A block is taken from
+    //        the list of its size before the heap is asked for one, so a program
+    //        run again makes its objects without allocating.  Each block is a heap
+    //        allocation of its own, so a block may be released by any thread.
+    //
+    /********************************************************************************************/
+
+    class object_pool {
+    public:
+
+        static const     std::size_t ALIGNMENT;     // The size of a block is a multiple of this.
+        static constexpr std::size_t SIZES = 16;    // The number of block sizes pooled.
+        static const     std::size_t MAX_FREE;      // The most blocks of a size kept by a thread.
+
+        static void* allocate(std::size_t bytes);
+        static void deallocate(void* p, std::size_t bytes);
+
+        static void reserve(std::size_t bytes, std::size_t count);
+        static std::size_t free_blocks(std::size_t bytes);
+
+    private:
+
+        struct block {
+            block* next;
+        };
+
+        struct free_lists {
+            block*      head[SIZES];
+            std::size_t count[SIZES];
+
+            ~free_lists();
+        };
+
+        static thread_local free_lists _lists;
+        static thread_local bool       _closed;     // The lists of this thread have been released.
+
+        static std::size_t size_class(std::size_t bytes);
+    };
+
+
+
+    /********************************************************************************************/
+    //
+    //                                'pool_allocator' class definition
+    //
+    //        A standard allocator over the object_pool, for single objects.  Arrays
+    //        are left to the heap.
+    //
+    /********************************************************************************************/
+
+    template <typename T>
+    class pool_allocator {
+    public:
+
+        typedef     T   value_type;
+
+        pool_allocator() noexcept = default;
+
+        template <typename U>
+        pool_allocator(const pool_allocator<U>&) noexcept {
+        }
+
+        T* allocate(std::size_t n);
+        void deallocate(T* p, std::size_t n) noexcept;
+
+        template <typename U>
+        bool operator == (const pool_allocator<U>&) const noexcept {
+            return true;
+        }
+
+        template <typename U>
+        bool operator != (const pool_allocator<U>&) const noexcept {
+            return false;
+        }
+    };
+
+
+
+    const std::size_t object_pool::ALIGNMENT = 16;
+    const std::size_t object_pool::MAX_FREE  = 1 << 16;
+
+    thread_local object_pool::free_lists object_pool::_lists   = {};
+    thread_local bool                    object_pool::_closed  = false;
+
+    object_pool::free_lists::~free_lists() {
+
+        for (std::size_t i = 0; i < SIZES; ++i) {
+
+            while (head[i]) {
+
+                block* b = head[i];
+
+                head[i] = b->next;
+
+                ::operator delete(b);
+            }
+        }
+
+        _closed = true;
+    }
+
+    inline std::size_t object_pool::size_class(std::size_t bytes) {
+        /*
+            Return the index of the list for blocks of a size,
+            or SIZES when the size is too large to pool.
+        */
+
+        return bytes ? (bytes - 1) / ALIGNMENT : SIZES;
+    }
+
+    inline void* object_pool::allocate(std::size_t bytes) {
+
+        std::size_t i = size_class(bytes);
+
+        if (i < SIZES && !_closed) {
+
+            free_lists& lists = _lists;
+
+            if (lists.head[i]) {
+
+                block* b = lists.head[i];
+
+                lists.head[i]   = b->next;
+                lists.count[i] -= 1;
+
+                return b;
+            }
+
+            return ::operator new((i + 1) * ALIGNMENT);
+        }
+
+        return ::operator new(bytes);
+    }
+
+    inline void object_pool::deallocate(void* p, std::size_t bytes) {
+        /*
+            Once a thread's lists are released, at its exit,
+            blocks are returned to the heap.
+        */
+
+        std::size_t i = size_class(bytes);
+
+        if (i < SIZES && !_closed) {
+
+            free_lists& lists = _lists;
+
+            if (lists.count[i] < MAX_FREE) {
+
+                block* b = static_cast<block*>(p);
+
+                b->next         = lists.head[i];
+                lists.head[i]   = b;
+                lists.count[i] += 1;
+
+                return;
+            }
+        }
+
+        ::operator delete(p);
+    }
+
+    inline void object_pool::reserve(std::size_t bytes, std::size_t count) {
+        /*
+            Place blocks of a size on this thread's list, until
+            it holds at least count of them.
+        */
+
+        std::size_t i = size_class(bytes);
+
+        if (i >= SIZES || _closed) {
+            return;
+        }
+
+        while (_lists.count[i] < count && _lists.count[i] < MAX_FREE) {
+            deallocate(::operator new((i + 1) * ALIGNMENT), bytes);
+        }
+    }
+
+    inline std::size_t object_pool::free_blocks(std::size_t bytes) {
+
+        std::size_t i = size_class(bytes);
+
+        return (i < SIZES && !_closed) ? _lists.count[i] : 0;
+    }
+
+    template <typename T>
+    inline T* pool_allocator<T>::allocate(std::size_t n) {
+
+        if (n == 1) {
+            return static_cast<T*>(object_pool::allocate(sizeof(T)));
+        }
+
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    template <typename T>
+    inline void pool_allocator<T>::deallocate(T* p, std::size_t n) noexcept {
+
+        if (n == 1) {
+            object_pool::deallocate(p, sizeof(T));
+            return;
+        }
+
+        ::operator delete(p);
+    }
+
+} // end Olly
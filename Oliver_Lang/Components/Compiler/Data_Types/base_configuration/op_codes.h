@@ -21,6 +21,9 @@
 //
 /********************************************************************************************/
 
+#include <iterator>
+#include <string_view>
+
 #include "system_fundamentals.h"
 
 namespace Olly {
@@ -56,8 +59,8 @@ namespace Olly {
 
         /**************************** Runtime Operators *****************************/
 
-            IDNT_op, STACK_op, CLEAR_op, QUEUE_op, LET_op, EMIT_op, ENDL_op,
-            let_op, def_op, function_op, map_op,
+            IDNT_op, STACK_op, CLEAR_op, QUEUE_op, LET_op, EMIT_op, ENDL_op, STATS_op,
+            let_op, def_op, function_op, map_op, memo_op,
             BIND_op, RETURN_op, assign_op,
             
 
@@ -66,6 +69,7 @@ namespace Olly {
             LEAD_op, LAST_op, DROP_op, PLACE_op,
             drop_lead_op, drop_last_op,
             place_lead_op, place_last_op,
+            range_op, generate_op, generate_next_op,
 
         SEQUENTIAL_OPERATORS,
 
@@ -86,11 +90,20 @@ namespace Olly {
         BINARY_OPERATORS,
 
 
-            end_scope_op,
+            end_scope_op, memo_end_op,
             APPLY_op,  return_op, result_op, 
 
         FUNCTION_OPERATORS,
 
+            PLACE_LEAD_op, PLACE_LAST_op, DROP_LEAD_op, DROP_LAST_op,
+            SYMBOL_ADD_op, LET_CONST_op,
+
+        SUPER_OPERATORS,
+
+            MAP_op, FILTER_op, REDUCE_op, FOLD_op, parallel_op,
+
+        COLLECTION_OPERATORS,
+
             
         END_OPERATORS_OP,
 
@@ -131,20 +144,27 @@ namespace Olly {
 
     /********************************************************************************************/
     //
-    //                                 Interpreter Operator Map
+    //                                 Interpreter Operator Names
     //
     /********************************************************************************************/
 
-    static const std::map<str_type, OP_CODE> OPERATORS = {
+    struct operator_name {
+        std::string_view    name;
+        OP_CODE             code;
+    };
+
+    constexpr operator_name OPERATOR_NAMES[] = {
 
         { "none",            OP_CODE::NOTHING_OP },    { "nothing",         OP_CODE::NOTHING_OP },
         { "STACK",             OP_CODE::STACK_op },    { "QUEUE",             OP_CODE::QUEUE_op },
         { "CLEAR",             OP_CODE::CLEAR_op },    { "EMIT",               OP_CODE::EMIT_op },
         { "LET",                 OP_CODE::LET_op },    { "ENDL",               OP_CODE::ENDL_op },
+        { "STATS",             OP_CODE::STATS_op },
         { "let",                 OP_CODE::let_op },    { "@",                  OP_CODE::IDNT_op },
         
         { "func",           OP_CODE::function_op },
         { "function",       OP_CODE::function_op },    { "map",                 OP_CODE::map_op },
+        { "memo",               OP_CODE::memo_op },
         { "BIND",               OP_CODE::BIND_op },    { "#",             OP_CODE::end_scope_op },
         { "==>",              OP_CODE::RETURN_op },    { "<==",              OP_CODE::assign_op },
 
@@ -152,6 +172,11 @@ namespace Olly {
         { "PLACE",             OP_CODE::PLACE_op },    { "DROP",               OP_CODE::DROP_op },
         { "-->",          OP_CODE::place_lead_op },    { "<--",          OP_CODE::place_last_op },
         { ">>>",           OP_CODE::drop_lead_op },    { "<<<",           OP_CODE::drop_last_op },
+        { "range",             OP_CODE::range_op },    { "generate",       OP_CODE::generate_op },
+
+        { "MAP",                 OP_CODE::MAP_op },    { "FILTER",           OP_CODE::FILTER_op },
+        { "REDUCE",           OP_CODE::REDUCE_op },    { "FOLD",               OP_CODE::FOLD_op },
+        { "parallel",       OP_CODE::parallel_op },
 
         { "GET",                 OP_CODE::GET_op },    { "HAS",                 OP_CODE::HAS_op },
         { "SET",                 OP_CODE::SET_op },    { "DEL",                 OP_CODE::DEL_op },
@@ -177,6 +202,10 @@ namespace Olly {
         { "NE",                    OP_CODE::NE_op },    { "GT",                   OP_CODE::GT_op },
         { "LT",                    OP_CODE::LT_op },    { "GE",                   OP_CODE::GE_op },
 
+        { "PLACE_LEAD",     OP_CODE::PLACE_LEAD_op },    { "PLACE_LAST",     OP_CODE::PLACE_LAST_op },
+        { "DROP_LEAD",       OP_CODE::DROP_LEAD_op },    { "DROP_LAST",       OP_CODE::DROP_LAST_op },
+        { "SYMBOL_ADD",     OP_CODE::SYMBOL_ADD_op },    { "LET_CONST",       OP_CODE::LET_CONST_op },
+
         /**********  UNSORTED **********/
 
  
@@ -238,4 +267,254 @@ namespace Olly {
 
     };
 
+    /********************************************************************************************/
+    //
+    //                              'operator_table' class definition
+    //
+    //        The operator_table class is a perfect hash of the operator names, built
+    //        at compile time.  A word is found with a single probe, hashing and then
+    //        comparing it without regard to case, and without copying it.
+    //
+    //        Names which differ only in case share an entry, which finds the operator
+    //        of the lower case name, or of the upper case name if there is no lower
+    //        case one.  A collection operator is also found by its own spelling, so
+    //        that the upper case collection operators are kept apart from the lower
+    //        case words of the same name.
+    //
+    /********************************************************************************************/
+
+    class operator_table {
+    public:
+
+        static constexpr size_type SLOTS = 1024;    // A power of two, well above the number of names, so a seed is soon found.
+
+    private:
+
+        struct entry {
+            std::string_view    name;
+            OP_CODE             code        = OP_CODE::NOTHING_OP;
+            bool_type           any_case    = false;    // Found in any case, by a lower or upper case name.
+            std::string_view    exact;                  // A collection operator's name, as written.
+            OP_CODE             exact_code  = OP_CODE::NOTHING_OP;
+        };
+
+        static constexpr size_type      NAMES = std::size(OPERATOR_NAMES);
+        static constexpr size_type      CODES = static_cast<size_type>(OP_CODE::END_OPERATORS_OP) + 1;
+        static constexpr std::uint8_t   EMPTY = 0xFF;
+
+        static_assert(NAMES < EMPTY, "Each entry must be indexed by a byte.");
+        static_assert((SLOTS & (SLOTS - 1)) == 0, "The slots must be a power of two.");
+
+        entry               _entries[NAMES];
+        size_type           _size;
+        size_type           _longest;
+        std::uint8_t        _slots[SLOTS];      // The entry of each hash, or EMPTY.
+        std::uint32_t       _seed;
+        std::string_view    _names[CODES];      // The first name of each operator, in sorted order.
+
+    public:
+
+        constexpr operator_table();
+
+        constexpr const OP_CODE* find(std::string_view word) const;
+        constexpr std::string_view name(OP_CODE code) const;
+
+        constexpr size_type size() const;
+        constexpr std::uint32_t seed() const;
+
+    private:
+
+        static constexpr char fold(char c);
+        static constexpr bool_type same(std::string_view a, std::string_view b);
+        static constexpr bool_type is_case(std::string_view word, bool_type upper);
+        static constexpr bool_type is_collection(OP_CODE code);
+        static constexpr std::uint32_t hash(std::string_view word, std::uint32_t seed);
+    };
+
+    /********************************************************************************************/
+    //
+    //   operator_table implimentation.
+    //
+    /********************************************************************************************/
+
+    constexpr operator_table::operator_table() : _entries(), _size(0), _longest(0), _slots(), _seed(0), _names() {
+        /*
+            Gather the names into entries, then try seeds
+            until every entry hashes to a slot of its own.
+            A name in mixed case is only found as written,
+            and only if it is a collection operator, just
+            as when names were looked up in each case.
+        */
+
+        bool_type lower[NAMES] = {};
+
+        for (const operator_name& n : OPERATOR_NAMES) {
+
+            size_type i = 0;
+
+            while (i < _size && !same(_entries[i].name, n.name)) {
+                ++i;
+            }
+
+            if (i == _size) {
+                _entries[_size++] = entry{ n.name, OP_CODE::NOTHING_OP, false, {}, OP_CODE::NOTHING_OP };
+            }
+
+            entry& e = _entries[i];
+
+            if (is_case(n.name, false)) {
+                e.code     = n.code;
+                e.any_case = true;
+                lower[i]   = true;
+            }
+            else if (is_case(n.name, true) && !lower[i]) {
+                e.code     = n.code;
+                e.any_case = true;
+            }
+
+            if (is_collection(n.code)) {
+
+                if (!e.exact.empty()) {
+                    throw "Two collection operators differ only in case.";
+                }
+
+                e.exact      = n.name;
+                e.exact_code = n.code;
+            }
+
+            if (n.name.size() > _longest) {
+                _longest = n.name.size();
+            }
+
+            size_type code = static_cast<size_type>(n.code);
+
+            if (_names[code].empty() || n.name < _names[code]) {
+                _names[code] = n.name;
+            }
+        }
+
+        for (std::uint32_t seed = 1; !_seed; ++seed) {
+
+            for (std::uint8_t& slot : _slots) {
+                slot = EMPTY;
+            }
+
+            _seed = seed;
+
+            for (size_type i = 0; i < _size; ++i) {
+
+                std::uint8_t& slot = _slots[hash(_entries[i].name, seed) & (SLOTS - 1)];
+
+                if (slot != EMPTY) {
+                    _seed = 0;
+                    break;
+                }
+
+                slot = static_cast<std::uint8_t>(i);
+            }
+        }
+    }
+
+    constexpr const OP_CODE* operator_table::find(std::string_view word) const {
+        /*
+            Return the operator of a word, or a null
+            pointer if the word names no operator.
+        */
+
+        if (word.empty() || word.size() > _longest) {
+            return nullptr;
+        }
+
+        std::uint8_t i = _slots[hash(word, _seed) & (SLOTS - 1)];
+
+        if (i == EMPTY || !same(_entries[i].name, word)) {
+            return nullptr;
+        }
+
+        const entry& e = _entries[i];
+
+        if (!e.exact.empty() && e.exact == word) {
+            return &e.exact_code;
+        }
+
+        return e.any_case ? &e.code : nullptr;
+    }
+
+    constexpr std::string_view operator_table::name(OP_CODE code) const {
+        /*
+            Return the name an operator is written
+            with, or an empty name if it has none.
+        */
+
+        size_type i = static_cast<size_type>(code);
+
+        return i < CODES ? _names[i] : std::string_view();
+    }
+
+    constexpr size_type operator_table::size() const {
+        return _size;
+    }
+
+    constexpr std::uint32_t operator_table::seed() const {
+        return _seed;
+    }
+
+    constexpr char operator_table::fold(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    constexpr bool_type operator_table::same(std::string_view a, std::string_view b) {
+
+        if (a.size() != b.size()) {
+            return false;
+        }
+
+        for (size_type i = 0; i < a.size(); ++i) {
+
+            if (fold(a[i]) != fold(b[i])) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    constexpr bool_type operator_table::is_case(std::string_view word, bool_type upper) {
+
+        for (char c : word) {
+
+            if (upper ? (c >= 'a' && c <= 'z') : (c >= 'A' && c <= 'Z')) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    constexpr bool_type operator_table::is_collection(OP_CODE code) {
+        return code > OP_CODE::SUPER_OPERATORS && code < OP_CODE::COLLECTION_OPERATORS;
+    }
+
+    constexpr std::uint32_t operator_table::hash(std::string_view word, std::uint32_t seed) {
+        /*
+            FNV-1a of the word in lower case, from a
+            seeded basis, with its bits mixed down.
+        */
+
+        std::uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+
+        for (char c : word) {
+            h ^= static_cast<std::uint8_t>(fold(c));
+            h *= 16777619u;
+        }
+
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+
+        return h;
+    }
+
+    static constexpr operator_table OPERATORS;
+
 } // end
@@ -24,11 +24,13 @@
 #include <algorithm>
 #include <bitset>
 #include <cctype>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <regex>
 #include <sstream>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -62,6 +62,8 @@ namespace Olly {
         friend let             _reverse_(const expression& self);
 
         friend let                 _add_(const expression& self, const let& other);
+
+        friend void           _children_(const expression& self, std::vector<let>& out);
     };
 
     let make_pair(let key, let val);
@@ -82,6 +84,27 @@ namespace Olly {
     }
 
     expression::~expression() {
+        /*
+            Release the nodes of the tail which are held only by
+            this one in a loop.  Else each node would free the
+            next in its own destructor, and a long expression
+            would overflow the call stack.
+        */
+
+        let next = std::move(_next);
+
+        while (next.unique()) {
+
+            expression* node = const_cast<expression*>(next.cast<expression>());
+
+            if (!node) {
+                break;
+            }
+
+            let tail = std::move(node->_next);
+
+            next = std::move(tail);
+        }
     }
 
     std::string _type_(const expression& self) {
@@ -282,4 +305,10 @@ namespace Olly {
 
         return exp;
     }
+
+    void _children_(const expression& self, std::vector<let>& out) {
+
+        out.push_back(self._data);
+        out.push_back(self._next);
+    }
 }
\ No newline at end of file
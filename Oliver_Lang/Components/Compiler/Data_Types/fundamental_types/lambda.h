@@ -31,11 +31,13 @@ namespace Olly {
     //
     //          The lambda class is an ananymous lambda in Oliver. It consists of
     //          arguments, a body, and a scope.  Individual variables can be bound to
-    //          the scope of a lambda after its definition.  
+    //          the scope of a lambda after its definition.  A lambda marked with
+    //          'memo' has the results of its calls cached by the evaluator, keyed
+    //          by its arguments and by the values of the free symbols of its body.
     //
     /********************************************************************************************/
 
-    typedef     std::map<str_type, let>    map_type;
+    typedef     std::map<str_type, let, std::less<str_type>, pool_allocator<std::pair<const str_type, let>>>    map_type;
 
     class lambda {
 
@@ -44,6 +46,9 @@ namespace Olly {
 
         map_type  _scope;
 
+        bool_type _memo;
+        let       _free;    // The symbols the body reads from the scope of its caller, if memoized.
+
     public:
 
         lambda();
@@ -61,12 +66,17 @@ namespace Olly {
         friend size_type          _size_(const lambda& self);
         friend let                _lead_(const lambda& self);
         friend let                _last_(const lambda& self);
+        friend void           _children_(const lambda& self, std::vector<let>& out);
 
         void bind_scope(const map_type& scope);
         void bind_variable(let var, let val);
 
         map_type variables() const;
 
+        void memoize(let free);
+        bool_type is_memoized() const;
+        let free_symbols() const;
+
         void print_enclosure() const;
     };
 
@@ -76,13 +86,13 @@ namespace Olly {
     //
     /********************************************************************************************/
 
-    lambda::lambda() : _args(expression()), _body(expression()), _scope() {
+    lambda::lambda() : _args(expression()), _body(expression()), _scope(), _memo(false), _free(expression()) {
     }
 
-    lambda::lambda(const lambda& exp) : _args(exp._args), _body(exp._body), _scope(exp._scope) {
+    lambda::lambda(const lambda& exp) : _args(exp._args), _body(exp._body), _scope(exp._scope), _memo(exp._memo), _free(exp._free) {
     }
 
-    lambda::lambda(let exp) : _args(), _body(), _scope() {
+    lambda::lambda(let exp) : _args(), _body(), _scope(), _memo(false), _free(expression()) {
 
         const lambda* l = exp.cast<lambda>();
 
@@ -90,10 +100,12 @@ namespace Olly {
             _args = l->_args;
             _body = l->_body;
             _scope = l->_scope;
+            _memo = l->_memo;
+            _free = l->_free;
         }
     }
 
-    lambda::lambda(let args, let body) : _args(args), _body(), _scope() {
+    lambda::lambda(let args, let body) : _args(args), _body(body), _scope(), _memo(false), _free(expression()) {
     }
 
     lambda::~lambda() {
@@ -221,6 +233,19 @@ namespace Olly {
         return _scope;
     }
 
+    inline void lambda::memoize(let free) {
+        _memo = true;
+        _free = free;
+    }
+
+    inline bool_type lambda::is_memoized() const {
+        return _memo;
+    }
+
+    inline let lambda::free_symbols() const {
+        return _free;
+    }
+
     inline void Olly::lambda::print_enclosure() const {
 
         for (auto itr : _scope) {
@@ -228,4 +253,15 @@ namespace Olly {
         }
     }
 
+    void _children_(const lambda& self, std::vector<let>& out) {
+
+        out.push_back(self._args);
+        out.push_back(self._body);
+        out.push_back(self._free);
+
+        for (const auto& var : self._scope) {
+            out.push_back(var.second);
+        }
+    }
+
 } // end
\ No newline at end of file
@@ -71,6 +71,7 @@ namespace Olly {
         friend let                 _add_(const list& self, const let& other);
         friend bool_type           _has_(const list& self, const let& other);
         friend let               _clear_(const list& self);
+        friend void           _children_(const list& self, std::vector<let>& out);
 
     private:
         void balance();
@@ -370,4 +371,10 @@ namespace Olly {
 
         return list();
     }
+
+    void _children_(const list& self, std::vector<let>& out) {
+
+        out.push_back(self._lead);
+        out.push_back(self._last);
+    }
 }
\ No newline at end of file
@@ -62,6 +62,13 @@ namespace Olly {
         friend let          _l_or_(const boolean& self, const let& other);
         friend let         _l_xor_(const boolean& self, const let& other);
         friend let           _neg_(const boolean& self);
+
+        friend let         _l_and_(const boolean& self, const boolean& other);
+        friend let          _l_or_(const boolean& self, const boolean& other);
+        friend let         _l_xor_(const boolean& self, const boolean& other);
+
+        real_type   term() const;
+        real_type weight() const;
     };
 
 
@@ -129,6 +136,14 @@ namespace Olly {
     boolean::~boolean() {
     }
 
+    real_type boolean::term() const {
+        return _term;
+    }
+
+    real_type boolean::weight() const {
+        return _weight;
+    }
+
     std::string _type_(const boolean& self) {
         return "boolean";
     }
@@ -182,12 +197,7 @@ namespace Olly {
         const boolean* b = other.cast<boolean>();
 
         if (b) {
-
-            real_type t = std::fmin(self._term, b->_term);
-
-            real_type w = (self._weight + b->_weight) / 2.0;
-
-            return boolean(t, w);
+            return _l_and_(self, *b);
         }
 
         return boolean(NOT_A_NUMBER);
@@ -198,12 +208,7 @@ namespace Olly {
         const boolean* b = other.cast<boolean>();
 
         if (b) {
-
-            real_type t = std::fmax(self._term, b->_term);
-
-            real_type w = (self._weight + b->_weight) / 2.0;
-
-            return boolean(t, w);
+            return _l_or_(self, *b);
         }
 
         return boolean(NOT_A_NUMBER);
@@ -214,27 +219,49 @@ namespace Olly {
         const boolean* b = other.cast<boolean>();
 
         if (b) {
+            return _l_xor_(self, *b);
+        }
+
+        return boolean(NOT_A_NUMBER);
+    }
 
-            real_type t = std::fmax(self._term, b->_term);
+    let Olly::_l_and_(const boolean& self, const boolean& other) {
 
-            real_type w = (self._weight + b->_weight) / 2.0;
+        real_type t = std::fmin(self._term, other._term);
 
-            boolean res(t, w);
+        real_type w = (self._weight + other._weight) / 2.0;
 
-            
-            real_type x = self._term - self._weight;
+        return boolean(t, w);
+    }
 
-            real_type y = b->_term - b->_weight;
+    let Olly::_l_or_(const boolean& self, const boolean& other) {
 
-            if ((x < 0.0) ^ (y < 0.0)) {
+        real_type t = std::fmax(self._term, other._term);
 
-                return res;
-            }
+        real_type w = (self._weight + other._weight) / 2.0;
+
+        return boolean(t, w);
+    }
+
+    let Olly::_l_xor_(const boolean& self, const boolean& other) {
+
+        real_type t = std::fmax(self._term, other._term);
 
-            return x + y ? res : _neg_(res);
+        real_type w = (self._weight + other._weight) / 2.0;
+
+        boolean res(t, w);
+
+            
+        real_type x = self._term - self._weight;
+
+        real_type y = other._term - other._weight;
+
+        if ((x < 0.0) ^ (y < 0.0)) {
+
+            return res;
         }
 
-        return boolean(NOT_A_NUMBER);
+        return x + y ? res : _neg_(res);
     }
 
     let Olly::_neg_(const boolean& self) {
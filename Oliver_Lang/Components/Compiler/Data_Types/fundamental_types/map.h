@@ -70,6 +70,7 @@ namespace Olly {
         friend let       _to_expression_(const map& self);
 
         friend let                 _add_(const map& self, const let& other);
+        friend void           _children_(const map& self, std::vector<let>& out);
 
     private:
         typedef std::vector<bool_type> direction_queue;
@@ -658,4 +659,8 @@ namespace Olly {
 
         return node;
     }
+
+    void _children_(const map& self, std::vector<let>& out) {
+        out.push_back(self._node);
+    }
 }
@@ -57,6 +57,7 @@ namespace Olly {
         friend str_type      _type_(const number& self);
         friend bool_type       _is_(const number& self);
         friend real_type     _comp_(const number& self, const let& other);
+        friend real_type     _comp_(const number& self, const number& other);
         friend void        _str_(stream_type& out, const number& self);
         friend void       _repr_(stream_type& out, const number& self);
 
@@ -64,6 +65,12 @@ namespace Olly {
         friend let         _sub_(const number& self, const let& other);
         friend let         _mul_(const number& self, const let& other);
         friend let         _div_(const number& self, const let& other);
+
+        friend let         _add_(const number& self, const number& other);
+        friend let         _sub_(const number& self, const number& other);
+        friend let         _mul_(const number& self, const number& other);
+        friend let         _div_(const number& self, const number& other);
+
         friend let         _mod_(const number& self, const let& other);
         friend let         _neg_(const number& self);
 
@@ -75,6 +82,8 @@ namespace Olly {
         friend bool_type  _complex_(const number& self);
 
         int_type integer() const;
+        real_type   real() const;
+        real_type   imag() const;
 
     private:
         typedef		std::vector<str_type>		tokens_type;
@@ -181,25 +190,30 @@ namespace Olly {
         const number* n = other.cast<number>();
 
         if (n) {
-            if (_nan_(self) || _nan_(*n) || _complex_(self) || _complex_(*n)) {
-                return NOT_A_NUMBER;
-            }
+            return _comp_(self, *n);
+        }
+
+        return NOT_A_NUMBER;
+    }
 
-            real_type x = self._value.real();
-            real_type y = n->_value.real();
+    real_type _comp_(const number& self, const number& other) {
 
-            if (x > y) {
-                return 1.0;
-            }
+        if (_nan_(self) || _nan_(other) || _complex_(self) || _complex_(other)) {
+            return NOT_A_NUMBER;
+        }
 
-            if (x < y) {
-                return -1.0;
-            }
+        real_type x = self._value.real();
+        real_type y = other._value.real();
 
-            return 0.0;
+        if (x > y) {
+            return 1.0;
         }
 
-        return NOT_A_NUMBER;
+        if (x < y) {
+            return -1.0;
+        }
+
+        return 0.0;
     }
 
     void _str_(stream_type& out, const number& self) {
@@ -245,41 +259,57 @@ namespace Olly {
         const number* n = other.cast<number>();
 
         if (n) {
-            return number(self._value + n->_value);
+            return _add_(self, *n);
         }
         return nothing();
     }
 
+    let _add_(const number& self, const number& other) {
+        return number(self._value + other._value);
+    }
+
     let _sub_(const number& self, const let& other) {
 
         const number* n = other.cast<number>();
 
         if (n) {
-            return number(self._value - n->_value);
+            return _sub_(self, *n);
         }
         return nothing();
     }
 
+    let _sub_(const number& self, const number& other) {
+        return number(self._value - other._value);
+    }
+
     let _mul_(const number& self, const let& other) {
 
         const number* n = other.cast<number>();
 
         if (n) {
-            return number(self._value * n->_value);
+            return _mul_(self, *n);
         }
         return nothing();
     }
 
+    let _mul_(const number& self, const number& other) {
+        return number(self._value * other._value);
+    }
+
     let _div_(const number& self, const let& other) {
 
         const number* n = other.cast<number>();
 
         if (n) {
-            return number(self._value / n->_value);
+            return _div_(self, *n);
         }
         return nothing();
     }
 
+    let _div_(const number& self, const number& other) {
+        return number(self._value / other._value);
+    }
+
     let _mod_(const number& self, const let& other) {
 
         const number* n = other.cast<number>();
@@ -373,4 +403,14 @@ namespace Olly {
         return static_cast<int_type>(_value.real());
     }
 
+    real_type number::real() const {
+
+        return _value.real();
+    }
+
+    real_type number::imag() const {
+
+        return _value.imag();
+    }
+
 } // end
@@ -30,7 +30,8 @@ namespace Olly {
     //                                'op_call' Class Definition
     //
     //        The op_call class encapsulates system calls to functions within the
-    //        interpreter.  
+    //        interpreter.  A superinstruction may also carry the arguments which
+    //        it was fused with, available as the lead of the op_call.
     //
     /********************************************************************************************/
 
@@ -38,6 +39,7 @@ namespace Olly {
     class op_call {
 
         OP_CODE _value;
+        let     _args;
 
 
     public:
@@ -45,6 +47,7 @@ namespace Olly {
         op_call();
         op_call(const op_call& obj);
         op_call(OP_CODE val);
+        op_call(OP_CODE val, let args);
         op_call(str_type str);
         virtual ~op_call();
 
@@ -55,26 +58,33 @@ namespace Olly {
         friend real_type       _comp_(const op_call& self, const let& other);
         friend void          _str_(stream_type& out, const op_call& self);
         friend void         _repr_(stream_type& out, const op_call& self);
+        friend let          _lead_(const op_call& self);
         friend OP_CODE   _op_code_(const op_call& self);
+        friend void    _children_(const op_call& self, std::vector<let>& out);
     };
 
 
-    op_call::op_call() : _value() {
+    op_call::op_call() : _value(), _args() {
     }
 
-    op_call::op_call(const op_call& obj) : _value(obj._value) {
+    op_call::op_call(const op_call& obj) : _value(obj._value), _args(obj._args) {
     }
 
-    op_call::op_call(OP_CODE val) : _value(val) {
+    op_call::op_call(OP_CODE val) : _value(val), _args() {
     }
 
-    op_call::op_call(str_type str) : _value() {
+    op_call::op_call(OP_CODE val, let args) : _value(val), _args(args) {
+    }
+
+    op_call::op_call(str_type str) : _value(), _args() {
 
-        auto it = OPERATORS.find(str);
+        for (const operator_name& n : OPERATOR_NAMES) {
 
-        if (it != OPERATORS.end()) {
+            if (n.name == str) {
 
-            _value = it->second;
+                _value = n.code;
+                break;
+            }
         }
     }
 
@@ -115,13 +125,21 @@ namespace Olly {
 
     void _str_(stream_type& out, const op_call& self) {
 
-        for (auto it = OPERATORS.cbegin(); it != OPERATORS.cend(); ++it) {
+        std::string_view name = OPERATORS.name(self._value);
 
-            if (it->second == self._value) {
+        if (!name.empty()) {
 
-                out << it->first;
-                return;
+            out << name;
+
+            if (self._args.type() == "expression") {
+                self._args.str(out);
+            }
+            else if (self._args.is_something()) {
+                out << "(";
+                self._args.str(out);
+                out << ")";
             }
+            return;
         }
 
         out << "unknown_operator";
@@ -131,9 +149,17 @@ namespace Olly {
         _str_(out, self);
     }
 
+    let _lead_(const op_call& self) {
+        return self._args;
+    }
+
     OP_CODE _op_code_(const op_call& self) {
 
         return self._value;
     }
 
+    void _children_(const op_call& self, std::vector<let>& out) {
+        out.push_back(self._args);
+    }
+
 } // end
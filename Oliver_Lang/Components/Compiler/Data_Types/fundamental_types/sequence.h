@@ -0,0 +1,208 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//			Copyright 2019 Max J. Martin
+//
+//			This file is part of Oliver.
+//			
+//			Oliver is free software : you can redistribute it and / or modify
+//			it under the terms of the GNU General Public License as published by
+//			the Free Software Foundation, either version 3 of the License, or
+//			(at your option) any later version.
+//			
+//			Oliver is distributed in the hope that it will be useful,
+//			but WITHOUT ANY WARRANTY; without even the implied warranty of
+//			MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//			GNU General Public License for more details.
+//			
+//			You should have received a copy of the GNU General Public License
+//			along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//			
+/********************************************************************************************/
+
+#include <cmath>
+
+#include "../let.h"
+
+namespace Olly {
+
+    /********************************************************************************************/
+    //
+    //                               'sequence' Class Definition
+    //
+    //          The sequence class is a lazy sequence.  Its elements are produced
+    //          one at a time as it is walked with 'lead' and 'drop_lead', so a
+    //          pipeline over it holds one element at a time however long it is.
+    //
+    //          A range produces the numbers from 'start' up to, but excluding,
+    //          'stop'.  A generator holds its current element and the lambda
+    //          which produces the next element from it.  Calling the lambda is
+    //          the evaluator's work, so 'drop_lead' of a generator is nothing
+    //          and the evaluator steps it instead.  A generator ends once its
+    //          lambda returns nothing.
+    //
+    /********************************************************************************************/
+
+    class sequence {
+
+        let       _value;           // The current element.
+        let       _generator;       // The lambda producing the next element, or nothing for a range.
+        real_type _start;
+        real_type _stop;
+        real_type _step;
+
+    public:
+
+        sequence();
+        sequence(const sequence& obj);
+        sequence(real_type start, real_type stop, real_type step);
+        sequence(let value, let generator);
+        virtual ~sequence();
+
+        let generator() const;
+        let value() const;
+
+        friend str_type           _type_(const sequence& self);
+        friend bool_type            _is_(const sequence& self);
+        friend real_type          _comp_(const sequence& self, const let& other);
+
+        friend void                _str_(stream_type& out, const sequence& self);
+        friend void               _repr_(stream_type& out, const sequence& self);
+
+        friend size_type          _size_(const sequence& self);
+        friend let                _lead_(const sequence& self);
+        friend let           _drop_lead_(const sequence& self);
+        friend void           _children_(const sequence& self, std::vector<let>& out);
+    };
+
+    /********************************************************************************************/
+    //
+    //                                 'sequence' Class Implimentation
+    //
+    /********************************************************************************************/
+
+    sequence::sequence() : _value(nothing()), _generator(nothing()), _start(0.0), _stop(0.0), _step(1.0) {
+    }
+
+    sequence::sequence(const sequence& obj) : _value(obj._value), _generator(obj._generator), _start(obj._start), _stop(obj._stop), _step(obj._step) {
+    }
+
+    sequence::sequence(real_type start, real_type stop, real_type step) : _value(nothing()), _generator(nothing()), _start(start), _stop(stop), _step(step) {
+    }
+
+    sequence::sequence(let value, let generator) : _value(value), _generator(generator), _start(0.0), _stop(0.0), _step(1.0) {
+    }
+
+    sequence::~sequence() {
+    }
+
+    inline let sequence::generator() const {
+        return _generator;
+    }
+
+    inline let sequence::value() const {
+        return _value;
+    }
+
+    str_type _type_(const sequence& self) {
+        return "sequence";
+    }
+
+    bool_type _is_(const sequence& self) {
+
+        if (self._generator.is_something()) {
+            return self._value.is_something();
+        }
+
+        return (self._step > 0.0 && self._start < self._stop) || (self._step < 0.0 && self._start > self._stop);
+    }
+
+    real_type _comp_(const sequence& self, const let& other) {
+
+        const sequence* ptr = other.cast<sequence>();
+
+        if (ptr && self._generator.is_nothing() && ptr->_generator.is_nothing()) {
+
+            if (self._start == ptr->_start && self._stop == ptr->_stop && self._step == ptr->_step) {
+                return 0.0;
+            }
+        }
+
+        return NOT_A_NUMBER;
+    }
+
+    void _str_(stream_type& out, const sequence& self) {
+
+        if (self._generator.is_something()) {
+
+            if (!_is_(self)) {
+                out << "sequence()";
+                return;
+            }
+
+            out << "sequence(";
+            self._value.str(out);
+            out << " ...)";
+
+            return;
+        }
+
+        out << "range(" << self._start << " " << self._stop;
+
+        if (self._step != 1.0) {
+            out << " " << self._step;
+        }
+
+        out << ")";
+    }
+
+    void _repr_(stream_type& out, const sequence& self) {
+        _str_(out, self);
+    }
+
+    size_type _size_(const sequence& self) {
+        /*
+            The size of a generator is not known until it ends.
+        */
+
+        if (self._generator.is_something() || !_is_(self)) {
+            return 0;
+        }
+
+        return static_cast<size_type>(std::ceil((self._stop - self._start) / self._step));
+    }
+
+    let _lead_(const sequence& self) {
+
+        if (self._generator.is_something()) {
+            return self._value;
+        }
+
+        if (!_is_(self)) {
+            return nothing();
+        }
+
+        return number(self._start);
+    }
+
+    let _drop_lead_(const sequence& self) {
+
+        if (self._generator.is_something()) {
+            return nothing();
+        }
+
+        if (!_is_(self)) {
+            return self;
+        }
+
+        return sequence(self._start + self._step, self._stop, self._step);
+    }
+
+    void _children_(const sequence& self, std::vector<let>& out) {
+
+        out.push_back(self._value);
+        out.push_back(self._generator);
+    }
+
+}  // end Olly
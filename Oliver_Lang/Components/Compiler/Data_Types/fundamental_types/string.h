@@ -60,6 +60,9 @@ namespace Olly {
         friend let        _shift_(const string& self);
         friend let      _reverse_(const string& self);
 
+        friend let          _add_(const string& self, const let& other);
+        friend let          _add_(const string& self, const string& other);
+
         friend bool_type  _iterable_(const string& self);
     };
 
@@ -162,6 +165,26 @@ namespace Olly {
         return l;
     }
 
+    let _add_(const string& self, const let& other) {
+
+        const string* s = other.cast<string>();
+
+        if (s) {
+            return _add_(self, *s);
+        }
+
+        return nothing();
+    }
+
+    let _add_(const string& self, const string& other) {
+
+        string r;
+
+        r._value = self._value + other._value;
+
+        return r;
+    }
+
     bool_type _iterable_(const string& self) {
         return true;
     }
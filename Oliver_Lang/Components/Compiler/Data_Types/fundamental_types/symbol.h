@@ -47,6 +47,8 @@ namespace Olly {
         symbol(str_type str);
         virtual ~symbol();
 
+        const str_type& name() const;
+
         friend  stream_type& operator >> (stream_type& stream, symbol& self);
 
         friend bool           _is_(const symbol& self);
@@ -71,6 +73,10 @@ namespace Olly {
     symbol::~symbol() {
     }
 
+    inline const str_type& symbol::name() const {
+        return _value;
+    }
+
     stream_type& operator >> (stream_type& stream, symbol& self) {
 
         self = symbol(stream.str());
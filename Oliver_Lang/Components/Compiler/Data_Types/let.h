@@ -23,6 +23,8 @@
 
 #include "base_configuration/system_fundamentals.h"
 #include "base_configuration/op_codes.h"
+#include "base_configuration/object_pool.h"
+#include "base_configuration/let_stats.h"
 
 namespace Olly {
 
@@ -64,11 +66,23 @@ namespace Olly {
         template <typename T>          let(T  x);
         template <typename T>          let(T* x);
 
+#if OLIVER_LET_STATS
+        let(const let& obj);                                                        // Counted as a copy of the object.
+        let(let&& obj) noexcept = default;
+
+        let& operator = (const let& obj);
+        let& operator = (let&& obj) noexcept = default;
+#endif
+
         template <typename T> const T* cast()                              const;  // Cast the object as an instance of the specified type.
         template <typename T>       T  copy()                              const;  // Get a copy of the specified type.
 
         str_type             id()                                          const;  // Return the typeid of the object.
+        const std::type_info& type_id()                                    const;  // Return the typeid of the object without allocating.
         bool_type       is_type(const let& other)                          const;  // Compair two objects by typeid.
+        bool_type        unique()                                          const;  // Is this the only reference to the object.
+        static std::int64_t live_bytes();                                           // The bytes of objects made less those released by this thread.
+        static std::uint64_t made_bytes();                                          // The bytes of objects made by this thread.
         size_type          hash()                                          const;  // Get the hash of an object.
 
         str_type           type()                                          const;  // The class generated type name.
@@ -133,6 +147,10 @@ namespace Olly {
 
         str_type           help()                                          const;  // Define a string description of the object.
 
+        const void*     address()                                          const;  // The object held, shared by every copy of this 'let'.
+        size_type         bytes()                                          const;  // The size of the block holding the object.
+        void           children(std::vector<let>& out)                     const;  // Append the objects this object holds.
+
         // General object operator overloads.
 
         bool_type    operator==(const let& other)                          const;
@@ -165,6 +183,7 @@ namespace Olly {
 
             virtual void* _vptr() = 0;
             virtual str_type         _id()                                          const = 0;
+            virtual const std::type_info& _type_id()                                const = 0;
             virtual std::size_t      _hash()                                        const = 0;
 
             virtual str_type         _type()                                        const = 0;
@@ -222,6 +241,13 @@ namespace Olly {
             virtual str_type        _help()                                         const = 0;
 
             virtual OP_CODE         _op_code()                                      const = 0;
+
+            virtual size_type       _bytes()                                        const = 0;
+            virtual void            _children(std::vector<let>& out)                const = 0;
+
+#if OLIVER_LET_STATS
+            virtual size_type       _stats_slot()                                   const = 0;
+#endif
         };
 
         template <typename T>
@@ -237,10 +263,12 @@ namespace Olly {
             /******************************************************************************************/
 
             data_type(T val);
+            ~data_type();
             operator bool()                                                 const;
 
             void* _vptr();
             str_type        _id()                                           const;
+            const std::type_info& _type_id()                                const;
             std::size_t     _hash()                                         const;
 
             str_type        _type()                                         const;
@@ -299,10 +327,20 @@ namespace Olly {
 
             OP_CODE         _op_code()                                      const;
 
+            size_type       _bytes()                                        const;
+            void            _children(std::vector<let>& out)                const;
+
+#if OLIVER_LET_STATS
+            size_type       _stats_slot()                                   const;  // The index of the counters of this data type.
+#endif
+
             T               _data;
         };
 
         std::shared_ptr<const interface_type> _self;
+
+        static thread_local std::int64_t _live_bytes;
+        static thread_local std::uint64_t _made_bytes;
     };
 
     /********************************************************************************************/
@@ -772,6 +810,14 @@ namespace Olly {
     }
 
 
+    template<typename T>            /****  Append The Objects Held  ****/
+    void _children_(const T& self, std::vector<let>& out);
+
+    template<typename T>
+    inline void _children_(const T& self, std::vector<let>& out) {
+    }
+
+
     /********************************************************************************************/
     //
     //                                 'nothing' Class Implimentation
@@ -823,22 +869,25 @@ namespace Olly {
     //
     /********************************************************************************************/
 
-    inline let::let() : _self(std::make_shared<data_type<Olly::nothing>>(Olly::nothing())) {
+    /*
+        Objects are made in blocks of the object_pool, so the
+        values of a program run again reuse released blocks.
+    */
+
+    inline let::let() : _self(std::allocate_shared<data_type<Olly::nothing>>(pool_allocator<data_type<Olly::nothing>>(), Olly::nothing())) {
     }
 
     template <typename T>
-    inline let::let(T x) : _self(std::make_shared<data_type<T>>(std::move(x))) {
+    inline let::let(T x) : _self(std::allocate_shared<data_type<T>>(pool_allocator<data_type<T>>(), std::move(x))) {
     }
 
     template <typename T>
-    inline let::let(T* x) : _self(std::make_shared<data_type<T>>(x)) {
+    inline let::let(T* x) : _self(std::allocate_shared<data_type<T>>(pool_allocator<data_type<T>>(), x)) {
     }
 
     template <typename T> const inline T* let::cast() const {
 
-        let n = T();
-
-        if (is_type(n)) {
+        if (_self->_type_id() == typeid(T)) {
 
             const T* p = static_cast<T*>(const_cast<interface_type*>(_self.get())->_vptr());
 
@@ -854,7 +903,7 @@ namespace Olly {
 
         T n = T();
 
-        if (is_type(n)) {
+        if (_self->_type_id() == typeid(T)) {
 
             const T* p = static_cast<T*>(const_cast<interface_type*>(_self.get())->_vptr());
 
@@ -870,8 +919,12 @@ namespace Olly {
         return _self->_id();
     }
 
+    inline const std::type_info& let::type_id() const {
+        return _self->_type_id();
+    }
+
     inline bool_type let::is_type(const let& other) const {
-        return _self->_id() == other._self->_id();
+        return _self->_type_id() == other._self->_type_id();
     }
 
     inline std::size_t let::hash() const {
@@ -1046,6 +1099,27 @@ namespace Olly {
         return _self->_is_something();
     }
 
+    inline bool_type let::unique() const {
+        return _self.use_count() == 1;
+    }
+
+    thread_local std::int64_t let::_live_bytes = 0;
+    thread_local std::uint64_t let::_made_bytes = 0;
+
+    inline std::int64_t let::live_bytes() {
+        /*
+            Objects released by another thread are counted there,
+            so only the change in the count over a piece of work
+            done by this thread is meaningful.
+        */
+
+        return _live_bytes;
+    }
+
+    inline std::uint64_t let::made_bytes() {
+        return _made_bytes;
+    }
+
     inline bool_type let::is_set() const {
         return _self->_is_set();
     }
@@ -1070,6 +1144,18 @@ namespace Olly {
         return _self->_help();
     }
 
+    inline const void* let::address() const {
+        return _self.get();
+    }
+
+    inline size_type let::bytes() const {
+        return _self->_bytes();
+    }
+
+    inline void let::children(std::vector<let>& out) const {
+        _self->_children(out);
+    }
+
     inline bool_type let::operator==(const let& other) const {
         return eq(other);
     }
@@ -1122,8 +1208,57 @@ namespace Olly {
 
     template <typename T>
     inline let::data_type<T>::data_type(T val) : _data(std::move(val)) {
+
+        _live_bytes += sizeof(data_type<T>);
+        _made_bytes += sizeof(data_type<T>);
+
+#if OLIVER_LET_STATS
+        let_stats::made(_stats_slot(), sizeof(data_type<T>));
+#endif
     }
 
+    template <typename T>
+    inline let::data_type<T>::~data_type() {
+
+        _live_bytes -= sizeof(data_type<T>);
+
+#if OLIVER_LET_STATS
+        let_stats::freed(_stats_slot(), sizeof(data_type<T>));
+#endif
+    }
+
+#if OLIVER_LET_STATS
+    template <typename T>
+    inline size_type let::data_type<T>::_stats_slot() const {
+        /*
+            A data type is registered under its type name when
+            its first object is made.
+        */
+
+        static const size_type slot = let_stats::register_type(_type());
+
+        return slot;
+    }
+
+    inline let::let(const let& obj) : _self(obj._self) {
+
+        if (_self) {
+            let_stats::copied(_self->_stats_slot());
+        }
+    }
+
+    inline let& let::operator = (const let& obj) {
+
+        _self = obj._self;
+
+        if (_self) {
+            let_stats::copied(_self->_stats_slot());
+        }
+
+        return *this;
+    }
+#endif
+
     template <typename T>
     inline let::data_type<T>::operator bool() const {
         return _is();
@@ -1139,6 +1274,11 @@ namespace Olly {
         return typeid(_data).name();
     }
 
+    template <typename T>
+    inline const std::type_info& let::data_type<T>::_type_id() const {
+        return typeid(T);
+    }
+
     template <typename T>
     inline std::size_t let::data_type<T>::_hash() const {
         return _hash_(_data);
@@ -1354,6 +1494,16 @@ namespace Olly {
         return _op_code_(_data);
     }
 
+    template <typename T>
+    inline size_type let::data_type<T>::_bytes() const {
+        return sizeof(data_type<T>);
+    }
+
+    template <typename T>
+    inline void let::data_type<T>::_children(std::vector<let>& out) const {
+        _children_(_data, out);
+    }
+
     /********************************************************************************************/
     //
     //                            Basic Primitive Implementations
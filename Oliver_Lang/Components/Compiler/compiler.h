@@ -21,9 +21,14 @@
 //
 /********************************************************************************************/
 
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
-#include "../text_reader.h"
+#include "../parser.h"
+#include "../token.h"
+#include "../tracer.h"
 #include "Data_Types/let.h"
 #include "Data_Types/fundamental_types/expression.h"
 #include "Data_Types/fundamental_types/error.h"
@@ -33,6 +38,7 @@
 #include "Data_Types/fundamental_types/number.h"
 #include "Data_Types/fundamental_types/op_call.h"
 #include "Data_Types/fundamental_types/map.h"
+#include "Data_Types/fundamental_types/sequence.h"
 #include "Data_Types/fundamental_types/string.h"
 #include "Data_Types/fundamental_types/symbol.h"
 
@@ -55,17 +61,25 @@ namespace Olly {
 
         class compiler {
 
-            std::vector<std::string>    _tokens;
+            std::unique_ptr<parser>     _parser;    // The parser of text given to compile, which the tokens view.
+            token_list                  _tokens;
+            size_type                   _next;      // The next of '_tokens' to compile.
+            token_source*               _source;    // The source of the tokens, if not '_tokens'.
             let                         _code;
+            str_type                    _folded;    // A word in upper case, reused between words.
 
         public:
 
             compiler(std::string text);
-            compiler(std::vector<std::string> text);
+            compiler(token_list tokens);
+            compiler(token_source& source);
             virtual ~compiler();
 
             let compile();
 
+            static bool_type is_pure(let code);
+            static let free_symbols(let lam);
+
         private:
 
             compiler() = delete;
@@ -78,195 +92,207 @@ namespace Olly {
             let get_infix_operator(OP_CODE opr) const;
 
             void place_term(let t);
+            bool_type next_token(token& t);
 
-            str_type collect_string(tokens_type::const_iterator& word, const str_type& stop);
-        };
+            void place_word(std::string_view word);
+            void close_term(TOKEN_KIND kind);
 
+            static void collect_symbols(let code, std::vector<str_type>& bound, std::vector<str_type>& found);
 
+        };
 
-        compiler::compiler(std::string text) : _tokens(), _code(expression()) {
 
-            text_reader text_file(text);
 
-            // _code = _code.place_lead(expression());
-            while (text_file.is()) {
-                _tokens.push_back(text_file.get_line());
-            }
+        compiler::compiler(std::string text) : _parser(std::make_unique<parser>(text)), _tokens(), _next(0), _source(nullptr), _code(expression()), _folded() {
+            _source = _parser.get();
         }
 
-        compiler::compiler(std::vector<std::string> text) : _tokens(text), _code(expression()) {
+        compiler::compiler(token_list tokens) : _parser(), _tokens(std::move(tokens)), _next(0), _source(nullptr), _code(expression()), _folded() {
+        }
+
+        compiler::compiler(token_source& source) : _parser(), _tokens(), _next(0), _source(&source), _code(expression()), _folded() {
+            /*
+                Compile the tokens as they are taken from the
+                source, so that no more than the expressions
+                still open are held.
+            */
         }
 
         compiler::~compiler() {
         }
 
         let compiler::compile() {
+
+            tracer::span traced("compile", "compile");
+
             _code = _code.place_lead(expression());
 
-            auto word = _tokens.begin();
+            token word;
 
-            while (word != _tokens.cend()) {
+            while (next_token(word)) {
 
-                if (*word == "(" || *word == "[") {
+                switch (word.kind) {
+
+                case TOKEN_KIND::open_expression:
+                case TOKEN_KIND::open_list:
                     _code = _code.place_lead(expression());
-                    *word = "";
-                }
+                    break;
 
-                if (*word == "{") {
+                case TOKEN_KIND::open_map:
                     _code = _code.place_lead(expression());
                     place_term(op_call(OP_CODE::map_op));
+                    break;
+
+                case TOKEN_KIND::number:
+                    place_term(number(str_type(word.text)));
+                    break;
+
+                case TOKEN_KIND::string:
+                    place_term(string(decode(word)));
+                    break;
+
+                case TOKEN_KIND::close_expression:
+                case TOKEN_KIND::close_list:
+                case TOKEN_KIND::close_map:
+                    close_term(word.kind);
+                    break;
+
+                case TOKEN_KIND::regex:
+                case TOKEN_KIND::format:
+                    /*
+                        Regexes and formats are not yet compiled,
+                        and are read as their quotes and text.
+                    */
+                    place_word(word.kind == TOKEN_KIND::regex ? "\\" : "`");
+                    place_word(decode(word));
+                    place_word(word.kind == TOKEN_KIND::regex ? "\\" : "`");
+                    break;
+
+                default:
+                    place_word(word.text);
+                    break;
                 }
+            }
 
-                else if (*word == "\'") {
-                    str_type str = collect_string(word, "\'");
-
-                    place_term(number(str));
-                }
-
-                else if (*word == "\"") {
-                    str_type str = collect_string(word, "\"");
-
-                    place_term(string(str));
-                }
-
-                else if (*word == ")" || *word == "]" || *word == "}") {
-
-                    let terms = pop_lead(_code);
-
-                    let exp;
-                        
-                    if (*word == ")") {
-                        exp = expression();
-                    }
-                    else if (*word == "]") {
-                        exp = list();
-                    }
-                    else if (*word == "}") {
-                        exp = expression();
-                    }
-
-                    while (terms.is()) {
-
-                        let term = pop_lead(terms);
-
-                        if (term.op_code() == OP_CODE::function_op) {
-                            // Define an anonymous function.
-
-                            let a = pop_lead(exp);
-                            let b = pop_lead(exp);
+            return _code.lead().reverse();
+        }
 
-                            //if (b.op_code() == OP_CODE::start_scope_op) {
-                            //    
-                            //    b = pop_lead(exp).place_lead(b);
-                            //}
+        bool_type compiler::is_prefix_unary_operator(OP_CODE opr) const {
 
-                            exp = exp.place_lead(lambda(a, b));
-                        }
+            if (opr > OP_CODE::PREFIX_OPERATORS_START && opr < OP_CODE::PREFIX_OPERATORS_STOP) {
+                return true;
+            }
+            return false;
+        }
 
-                        else if (is_prefix_unary_operator(term.op_code())) {
-                            // Convert prefix unary operators to postix unary.
+        bool_type compiler::is_infix_binary_operator(OP_CODE opr) const {
 
-                            let a = pop_lead(exp);
-                            let b = get_postfix_operator(term.op_code());
+            if (opr > OP_CODE::INFIX_OPERATORS_START && opr < OP_CODE::INFIX_OPERATORS_STOP) {
+                return true;
+            }
+            return false;
+        }
 
-                            let p = expression();
+        bool_type compiler::is_pure(let code) {
+            /*
+                Code is pure when none of its terms write output or
+                clear the stack or queue.  The lambdas it calls by
+                name are not inspected.
+            */
 
-                            p = p.place_lead(b);
-                            p = p.place_lead(a);
+            if (code.type() == "lambda") {
+                return is_pure(code.last());
+            }
 
-                            exp = exp.place_lead(p);
-                        }
+            if (code.type() != "expression") {
 
-                        else if (is_infix_binary_operator(term.op_code())) {
-                            // Convert infix operators to postfix operators.
+                switch (code.op_code()) {
 
-                            let a = pop_lead(exp);
-                            let b = get_infix_operator(term.op_code());
+                case OP_CODE::EMIT_op:
+                case OP_CODE::ENDL_op:
+                case OP_CODE::STACK_op:
+                case OP_CODE::QUEUE_op:
+                case OP_CODE::CLEAR_op:
+                case OP_CODE::STATS_op:
+                    return false;
 
-                            exp = exp.place_lead(b);
-                            exp = exp.place_lead(a);
-                        }
+                default:
+                    break;
+                }
 
-                        else {  // Place the term on the expression, list, or map.
-                            exp = exp.place_lead(term);
-                        }
-                    }
-                    if (exp.lead().op_code() == OP_CODE::map_op) {
+                return true;
+            }
 
-                        let args = exp.drop_lead();
+            while (code.is()) {
 
-                        place_term(map(args));
-                    }
-                    else {
-                        place_term(exp);
-                    }
+                if (!is_pure(pop_lead(code))) {
+                    return false;
                 }
+            }
 
-                else if (*word != "") {
+            return true;
+        }
 
-                    str_type lower_case = to_lower(*word);
+        let compiler::free_symbols(let lam) {
+            /*
+                Return the symbols which the body of a lambda reads
+                and which are not its arguments, each once.  These
+                are read from the scope of its caller, and so form
+                part of the key of a memoized call.
+            */
 
-                    auto it = OPERATORS.find(lower_case);
+            std::vector<str_type> bound;
+            std::vector<str_type> found;
 
-                    if (it != OPERATORS.end()) {
+            collect_symbols(lam, bound, found);
 
-                        let opr = op_call(it->second);
+            let free = expression();
 
-                        place_term(opr);
-                    }
-                    else {
+            for (auto i = found.crbegin(); i != found.crend(); ++i) {
+                free = free.place_lead(symbol(*i));
+            }
 
-                        str_type upper_case = to_upper(*word);
+            return free;
+        }
 
-                        auto it = OPERATORS.find(upper_case);
+        void compiler::collect_symbols(let code, std::vector<str_type>& bound, std::vector<str_type>& found) {
+            /*
+                The arguments of a lambda are bound within its body,
+                including that of a lambda nested in another.
+            */
 
-                        if (it != OPERATORS.end()) {
+            str_type type = code.type();
 
-                            let opr = op_call(it->second);
+            if (type == "symbol") {
 
-                            place_term(opr);
-                        }
-                        else {
+                str_type name = str(code);
 
-                            if (upper_case == "TRUE" || upper_case == "FALSE" ||
-                                upper_case == "1" || upper_case == "0" ||
-                                upper_case == "UNDEF" || upper_case == "UNDEFINED") {
+                if (std::find(bound.cbegin(), bound.cend(), name) == bound.cend() && std::find(found.cbegin(), found.cend(), name) == found.cend()) {
+                    found.push_back(name);
+                }
+            }
 
-                                place_term(boolean(upper_case));
-                            }
+            else if (type == "lambda") {
 
-                            //if (upper_case == "ELSE") {
-                            //    place_term(boolean(true));
-                            //}
+                size_type depth = bound.size();
 
-                            else if (upper_case != "NOTHING" && upper_case != "NONE") {
+                let args = code.lead();
 
-                                place_term(symbol(*word));
-                            }
-                        }
-                    }
+                while (args.is()) {
+                    bound.push_back(str(pop_lead(args)));
                 }
 
-                ++word;
-            } 
+                collect_symbols(code.last(), bound, found);
 
-            return _code.lead().reverse();
-        }
-
-        bool_type compiler::is_prefix_unary_operator(OP_CODE opr) const {
-
-            if (opr > OP_CODE::PREFIX_OPERATORS_START && opr < OP_CODE::PREFIX_OPERATORS_STOP) {
-                return true;
+                bound.resize(depth);
             }
-            return false;
-        }
 
-        bool_type compiler::is_infix_binary_operator(OP_CODE opr) const {
+            else if (type == "expression" || type == "list") {
 
-            if (opr > OP_CODE::INFIX_OPERATORS_START && opr < OP_CODE::INFIX_OPERATORS_STOP) {
-                return true;
+                while (code.is()) {
+                    collect_symbols(pop_lead(code), bound, found);
+                }
             }
-            return false;
         }
 
         let compiler::get_postfix_operator(OP_CODE opr) const {
@@ -389,20 +415,145 @@ namespace Olly {
             _code = _code.place_lead(terms);
         }
 
-        str_type compiler::collect_string(tokens_type::const_iterator& word, const str_type& stop) {
+        void compiler::close_term(TOKEN_KIND kind) {
+            /*
+                Close the innermost expression, list or map,
+                placing it as a term of the one around it.
+            */
+
+            let terms = pop_lead(_code);
+
+            let exp;
+
+            if (kind == TOKEN_KIND::close_list) {
+                exp = list();
+            }
+            else {
+                exp = expression();
+            }
+
+            while (terms.is()) {
+
+                let term = pop_lead(terms);
+
+                if (term.op_code() == OP_CODE::function_op) {
+                    // Define an anonymous function.
+
+                    let a = pop_lead(exp);
+                    let b = pop_lead(exp);
+
+                    //if (b.op_code() == OP_CODE::start_scope_op) {
+                    //    
+                    //    b = pop_lead(exp).place_lead(b);
+                    //}
+
+                    exp = exp.place_lead(lambda(a, b));
+                }
+
+                else if (term.op_code() == OP_CODE::memo_op) {
+                    // Cache the calls of the lambda which follows.
+
+                    let f = pop_lead(exp);
+
+                    if (f.type() == "lambda" && is_pure(f.last())) {
+
+                        lambda l = f.copy<lambda>();
+                        l.memoize(free_symbols(f));
+
+                        f = l;
+                    }
+
+                    exp = exp.place_lead(f);
+                }
+
+                else if (is_prefix_unary_operator(term.op_code())) {
+                    // Convert prefix unary operators to postix unary.
+
+                    let a = pop_lead(exp);
+                    let b = get_postfix_operator(term.op_code());
+
+                    let p = expression();
+
+                    p = p.place_lead(b);
+                    p = p.place_lead(a);
+
+                    exp = exp.place_lead(p);
+                }
+
+                else if (is_infix_binary_operator(term.op_code())) {
+                    // Convert infix operators to postfix operators.
+
+                    let a = pop_lead(exp);
+                    let b = get_infix_operator(term.op_code());
+
+                    exp = exp.place_lead(b);
+                    exp = exp.place_lead(a);
+                }
+
+                else {  // Place the term on the expression, list, or map.
+                    exp = exp.place_lead(term);
+                }
+            }
+            if (exp.lead().op_code() == OP_CODE::map_op) {
+
+                let args = exp.drop_lead();
+
+                place_term(map(args));
+            }
+            else {
+                place_term(exp);
+            }
+        }
+
+        inline bool_type compiler::next_token(token& t) {
 
-            str_type text = "";
+            if (_source) {
+                return _source->next(t);
+            }
+
+            if (_next < _tokens.size()) {
+                t = _tokens[_next++];
+                return true;
+            }
 
-            ++word;
+            return false;
+        }
 
-            while (*word != stop && word != _tokens.cend()) {
+        void compiler::place_word(std::string_view word) {
+            /*
+                Place an operator, boolean or symbol.  The
+                word is only copied to be held by the term
+                made of it.
+            */
+
+            if (word.empty()) {
+                return;
+            }
 
-                text += *word;
+            const OP_CODE* opr = OPERATORS.find(word);
 
-                ++word;
+            if (opr) {
+                place_term(op_call(*opr));
+                return;
             }
 
-            return text;
+            assign_upper(_folded, word);
+
+            if (_folded == "TRUE" || _folded == "FALSE" ||
+                _folded == "1" || _folded == "0" ||
+                _folded == "UNDEF" || _folded == "UNDEFINED") {
+
+                place_term(boolean(_folded));
+            }
+
+            //if (_folded == "ELSE") {
+            //    place_term(boolean(true));
+            //}
+
+            else if (_folded != "NOTHING" && _folded != "NONE") {
+
+                place_term(symbol(str_type(word)));
+            }
         }
 
 } // end Olly
\ No newline at end of file
@@ -0,0 +1,652 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include "compiler.h"
+
+namespace Olly {
+
+        /********************************************************************************************/
+        //
+        //                                  'optimizer' class definition
+        //
+        //        The optimizer class accepts the code produced by the compiler and
+        //        rewrites it before evaluation.  Pure operators applied to literal
+        //        values are folded in to their result, and redundant nesting of
+        //        expressions is removed.
+        //
+        //        Lambdas take their arguments from the code which follows them, so
+        //        folding stops within an expression at the first symbol, lambda, or
+        //        operator which reads an unknown amount of the code after it.
+        //
+        //        Common sequences of terms are then fused in to superinstructions,
+        //        which the evaluator dispatches once.  A lambda which takes one as
+        //        an argument has it split back in to its original terms.
+        //
+        /********************************************************************************************/
+
+        class optimizer {
+
+            typedef     std::vector<let>    terms_type;
+
+            size_type   _terms_in;      // The number of terms in the code given to the optimizer.
+            size_type   _terms_out;     // The number of terms in the optimized code.
+            size_type   _folds;         // The number of operator applications folded.
+            size_type   _fusions;       // The number of superinstructions written.
+
+        public:
+
+            optimizer();
+            virtual ~optimizer();
+
+            let optimize(let code);
+
+            str_type report() const;
+
+        private:
+
+            optimizer(const optimizer& obj) = delete;
+
+            let fold_expression(let exp);
+            let fold_term(let term);
+
+            let fuse_expression(let exp);
+            let fuse_term(let term);
+
+            bool_type fold_operator(OP_CODE opr, terms_type& out, std::vector<bool_type>& literal);
+            bool_type fold_placement(OP_CODE opr, OP_CODE pos, terms_type& out, std::vector<bool_type>& literal);
+
+            bool_type is_literal(const let& term) const;
+            bool_type is_foldable(const let& result) const;
+            bool_type is_stack_operator(OP_CODE opr) const;
+            bool_type reads_next_term(OP_CODE opr) const;
+
+            size_type count_terms(let code) const;
+        };
+
+
+
+        optimizer::optimizer() : _terms_in(0), _terms_out(0), _folds(0), _fusions(0) {
+        }
+
+        optimizer::~optimizer() {
+        }
+
+        let optimizer::optimize(let code) {
+
+            if (code.type() != "expression") {
+                return code;
+            }
+
+            tracer::span traced("compile", "optimize");
+
+            _terms_in += count_terms(code);
+
+            code = fold_expression(unwrap_expresion(code));
+            code = fuse_expression(code);
+
+            _terms_out += count_terms(code);
+
+            return code;
+        }
+
+        str_type optimizer::report() const {
+
+            stream_type out;
+
+            out << "optimizer: " << _terms_in << " terms -> " << _terms_out << " terms";
+
+            if (_terms_in) {
+
+                real_type shrunk = 100.0 * (static_cast<real_type>(_terms_in) - static_cast<real_type>(_terms_out)) / _terms_in;
+
+                out.precision(3);
+                out << " (" << shrunk << "% smaller)";
+            }
+
+            out << ", " << _folds << " folds, " << _fusions << " fusions";
+
+            return out.str();
+        }
+
+        let optimizer::fold_expression(let exp) {
+            /*
+                Simulate the stack of the evaluator over the terms
+                of an expression.  Whenever a pure operator finds
+                its operands as literals on the top of that stack,
+                the operator is applied and its result replaces
+                the operands.
+            */
+
+            terms_type in;
+
+            while (exp.is()) {
+                in.push_back(pop_lead(exp));
+            }
+
+            terms_type             out;
+            std::vector<bool_type> literal;
+
+            bool_type barrier = false;
+
+            for (size_type i = 0; i < in.size(); ++i) {
+
+                let term = in[i];
+
+                if (term.type() == "op_call") {
+
+                    OP_CODE opr = term.op_code();
+
+                    if (!barrier && fold_operator(opr, out, literal)) {
+                        continue;
+                    }
+
+                    if (reads_next_term(opr) && i + 1 < in.size()) {
+                        /*
+                            Operators which read exactly the next term
+                            are kept with it verbatim.  A placement or
+                            drop is folded when its operands are known.
+                        */
+
+                        let pos = in[i + 1];
+
+                        i += 1;
+
+                        if (!barrier && fold_placement(opr, pos.op_code(), out, literal)) {
+                            continue;
+                        }
+
+                        out.push_back(term);
+                        literal.push_back(false);
+
+                        out.push_back(pos);
+                        literal.push_back(false);
+
+                        continue;
+                    }
+
+                    if (!is_stack_operator(opr)) {
+                        barrier = true;
+                    }
+
+                    out.push_back(term);
+                    literal.push_back(false);
+                }
+
+                else if (term.type() == "expression") {
+
+                    term = fold_term(term);
+
+                    out.push_back(term);
+                    literal.push_back(!barrier && is_literal(term));
+                }
+
+                else if (term.type() == "lambda" || term.type() == "symbol") {
+
+                    barrier = true;
+
+                    out.push_back(fold_term(term));
+                    literal.push_back(false);
+                }
+
+                else {
+                    out.push_back(term);
+                    literal.push_back(!barrier && is_literal(term));
+                }
+            }
+
+            let result = expression();
+
+            for (auto i = out.crbegin(); i != out.crend(); ++i) {
+                result = result.place_lead(*i);
+            }
+
+            return result;
+        }
+
+        let optimizer::fold_term(let term) {
+            /*
+                Fold the code nested within a term.  An expression
+                which folds to a single literal is replaced by it,
+                and the body of a lambda is folded in place.
+            */
+
+            if (term.type() == "expression") {
+
+                let exp = fold_expression(unwrap_expresion(term));
+
+                if (exp.size() == 1 && is_literal(exp.lead())) {
+                    return exp.lead();
+                }
+
+                return exp;
+            }
+
+            if (term.type() == "lambda") {
+
+                const lambda* l = term.cast<lambda>();
+
+                if (l && l->variables().empty() && term.last().type() == "expression") {
+
+                    let args = term.lead();
+
+                    if (args.is_nothing()) {
+                        args = expression();
+                    }
+
+                    lambda folded(args, fold_expression(term.last()));
+
+                    if (l->is_memoized()) {
+                        folded.memoize(l->free_symbols());
+                    }
+
+                    return folded;
+                }
+            }
+
+            return term;
+        }
+
+        let optimizer::fuse_expression(let exp) {
+            /*
+                Replace each of the sequences below with a single
+                superinstruction.
+
+                    PLACE LEAD              ->  PLACE_LEAD
+                    PLACE LAST              ->  PLACE_LAST
+                    DROP LEAD               ->  DROP_LEAD
+                    DROP LAST               ->  DROP_LAST
+                    symbol ADD              ->  SYMBOL_ADD(symbol)
+                    let symbol literal EQ   ->  LET_CONST(symbol literal)
+
+                Terms read verbatim by an operator are left as they
+                are, and nothing is fused after an operator which
+                reads an unknown amount of the code.
+            */
+
+            terms_type in;
+
+            while (exp.is()) {
+                in.push_back(pop_lead(exp));
+            }
+
+            terms_type out;
+
+            size_type skip    = 0;
+            bool_type barrier = false;
+
+            for (size_type i = 0; i < in.size(); ++i) {
+
+                let term = in[i];
+
+                if (skip || barrier) {
+                    /*
+                        A lambda read as a term is still code, so
+                        only its body is fused.
+                    */
+
+                    if (skip) {
+                        skip -= 1;
+                    }
+
+                    out.push_back(term.type() == "lambda" ? fuse_term(term) : term);
+                    continue;
+                }
+
+                let next = (i + 1 < in.size()) ? in[i + 1] : let(nothing());
+
+                if (term.type() == "op_call") {
+
+                    OP_CODE opr = term.op_code();
+                    OP_CODE pos = next.op_code();
+
+                    if ((opr == OP_CODE::PLACE_op || opr == OP_CODE::DROP_op) &&
+                        (pos == OP_CODE::LEAD_op  || pos == OP_CODE::LAST_op)) {
+
+                        if (opr == OP_CODE::PLACE_op) {
+                            opr = (pos == OP_CODE::LEAD_op) ? OP_CODE::PLACE_LEAD_op : OP_CODE::PLACE_LAST_op;
+                        }
+                        else {
+                            opr = (pos == OP_CODE::LEAD_op) ? OP_CODE::DROP_LEAD_op : OP_CODE::DROP_LAST_op;
+                        }
+
+                        out.push_back(op_call(opr));
+
+                        i += 1;
+                        _fusions += 1;
+                        continue;
+                    }
+
+                    if (opr == OP_CODE::let_op && i + 3 < in.size() &&
+                        next.type() == "symbol" && is_literal(in[i + 2]) && in[i + 3].op_code() == OP_CODE::EQ_op) {
+
+                        out.push_back(op_call(OP_CODE::LET_CONST_op, let(expression(in[i + 2])).place_lead(next)));
+
+                        i += 3;
+                        _fusions += 1;
+                        continue;
+                    }
+
+                    if (opr == OP_CODE::let_op) {
+                        skip = 3;
+                    }
+                    else if (reads_next_term(opr)) {
+                        skip = 1;
+                    }
+                    else if (!is_stack_operator(opr)) {
+                        barrier = true;
+                    }
+
+                    out.push_back(term);
+                }
+
+                else if (term.type() == "symbol" && next.op_code() == OP_CODE::ADD_op) {
+
+                    out.push_back(op_call(OP_CODE::SYMBOL_ADD_op, term));
+
+                    i += 1;
+                    _fusions += 1;
+                }
+
+                else {
+                    out.push_back(fuse_term(term));
+                }
+            }
+
+            let result = expression();
+
+            for (auto i = out.crbegin(); i != out.crend(); ++i) {
+                result = result.place_lead(*i);
+            }
+
+            return result;
+        }
+
+        let optimizer::fuse_term(let term) {
+
+            if (term.type() == "expression") {
+                return fuse_expression(term);
+            }
+
+            if (term.type() == "lambda") {
+
+                const lambda* l = term.cast<lambda>();
+
+                if (l && l->variables().empty() && term.last().type() == "expression") {
+
+                    let args = term.lead();
+
+                    if (args.is_nothing()) {
+                        args = expression();
+                    }
+
+                    lambda fused(args, fuse_expression(term.last()));
+
+                    if (l->is_memoized()) {
+                        fused.memoize(l->free_symbols());
+                    }
+
+                    return fused;
+                }
+            }
+
+            return term;
+        }
+
+        bool_type optimizer::fold_operator(OP_CODE opr, terms_type& out, std::vector<bool_type>& literal) {
+
+            size_type n = out.size();
+
+            if (opr > OP_CODE::UNARY_OPERATORS && opr < OP_CODE::BINARY_OPERATORS) {
+
+                if (n < 2 || !literal[n - 1] || !literal[n - 2]) {
+                    return false;
+                }
+
+                let x = out[n - 2];
+                let y = out[n - 1];
+
+                switch (opr) {
+
+                case OP_CODE::AND_op:  x = x.l_and(y);           break;
+                case OP_CODE::OR_op:   x = x.l_or(y);            break;
+                case OP_CODE::XOR_op:  x = x.l_xor(y);           break;
+                case OP_CODE::EQ_op:   x = boolean(x == y);      break;
+                case OP_CODE::NE_op:   x = boolean(x != y);      break;
+                case OP_CODE::GT_op:   x = boolean(x > y);       break;
+                case OP_CODE::GE_op:   x = boolean(x >= y);      break;
+                case OP_CODE::LT_op:   x = boolean(x < y);       break;
+                case OP_CODE::LE_op:   x = boolean(x <= y);      break;
+                case OP_CODE::ADD_op:  x = x + y;                break;
+                case OP_CODE::SUB_op:  x = x - y;                break;
+                case OP_CODE::MUL_op:  x = x * y;                break;
+                case OP_CODE::DIV_op:  x = x / y;                break;
+                case OP_CODE::MOD_op:  x = x % y;                break;
+                case OP_CODE::FDIV_op: x = x.f_div(y);           break;
+                case OP_CODE::REM_op:  x = x.rem(y);             break;
+                case OP_CODE::POW_op:  x = x.pow(y);             break;
+
+                default:
+                    return false;
+                }
+
+                if (!is_foldable(x)) {
+                    return false;
+                }
+
+                out.pop_back();
+                literal.pop_back();
+
+                out.back() = x;
+
+                _folds += 1;
+
+                return true;
+            }
+
+            if (opr == OP_CODE::NEG_op || opr == OP_CODE::POS_op ||
+                opr == OP_CODE::LEAD_op || opr == OP_CODE::LAST_op) {
+
+                if (n < 1 || !literal[n - 1]) {
+                    return false;
+                }
+
+                let x = out[n - 1];
+
+                switch (opr) {
+
+                case OP_CODE::POS_op:                            break;
+                case OP_CODE::NEG_op:  x = x.neg();              break;
+                case OP_CODE::LEAD_op: x = x.lead();             break;
+                case OP_CODE::LAST_op: x = x.last();             break;
+
+                default:
+                    return false;
+                }
+
+                if (!is_foldable(x)) {
+                    return false;
+                }
+
+                out.back() = x;
+
+                _folds += 1;
+
+                return true;
+            }
+
+            return false;
+        }
+
+        bool_type optimizer::fold_placement(OP_CODE opr, OP_CODE pos, terms_type& out, std::vector<bool_type>& literal) {
+            /*
+                Fold 'PLACE LEAD', 'PLACE LAST', 'DROP LEAD' and
+                'DROP LAST' applied to literal operands, in the same
+                manner as the evaluator's sequence operators.
+            */
+
+            size_type n = out.size();
+
+            if (pos != OP_CODE::LEAD_op && pos != OP_CODE::LAST_op) {
+                return false;
+            }
+
+            if (opr == OP_CODE::DROP_op) {
+
+                if (n < 1 || !literal[n - 1]) {
+                    return false;
+                }
+
+                let x = out[n - 1];
+
+                x = (pos == OP_CODE::LEAD_op) ? x.drop_lead() : x.drop_last();
+
+                if (!is_foldable(x)) {
+                    return false;
+                }
+
+                out.back() = x;
+
+                _folds += 1;
+
+                return true;
+            }
+
+            if (opr == OP_CODE::PLACE_op) {
+
+                if (n < 2 || !literal[n - 1] || !literal[n - 2]) {
+                    return false;
+                }
+
+                let x = out[n - 2];
+                let y = out[n - 1];
+
+                x = (pos == OP_CODE::LEAD_op) ? y.place_lead(x) : x.place_last(y);
+
+                if (!is_foldable(x)) {
+                    return false;
+                }
+
+                out.pop_back();
+                literal.pop_back();
+
+                out.back() = x;
+
+                _folds += 1;
+
+                return true;
+            }
+
+            return false;
+        }
+
+        bool_type optimizer::is_literal(const let& term) const {
+            /*
+                Literals are values which the evaluator places on
+                to the stack as they are.
+            */
+
+            str_type type = term.type();
+
+            return type == "number" || type == "string" || type == "boolean" || type == "list";
+        }
+
+        bool_type optimizer::is_foldable(const let& result) const {
+            /*
+                Only fold a result which is itself a literal.  An
+                unsupported operation, which yields 'nothing' or an
+                error, is left for the evaluator to report.
+            */
+
+            return is_literal(result);
+        }
+
+        bool_type optimizer::is_stack_operator(OP_CODE opr) const {
+            /*
+                Operators which only act on the stack, and so do
+                not read any of the code which follows them.
+            */
+
+            switch (opr) {
+
+            case OP_CODE::STACK_op:
+            case OP_CODE::STATS_op:
+            case OP_CODE::LET_op:
+            case OP_CODE::EMIT_op:
+            case OP_CODE::ENDL_op:
+            case OP_CODE::LEAD_op:
+            case OP_CODE::LAST_op:
+            case OP_CODE::drop_last_op:
+            case OP_CODE::end_scope_op:
+                return true;
+
+            default:
+                break;
+            }
+
+            return opr > OP_CODE::SEQUENTIAL_OPERATORS && opr < OP_CODE::BINARY_OPERATORS;
+        }
+
+        bool_type optimizer::reads_next_term(OP_CODE opr) const {
+            /*
+                Operators which read exactly one term of the code
+                which follows them.
+            */
+
+            switch (opr) {
+
+            case OP_CODE::IDNT_op:
+            case OP_CODE::CLEAR_op:
+            case OP_CODE::PLACE_op:
+            case OP_CODE::DROP_op:
+            case OP_CODE::place_lead_op:
+            case OP_CODE::place_last_op:
+            case OP_CODE::drop_lead_op:
+                return true;
+
+            default:
+                break;
+            }
+
+            return false;
+        }
+
+        size_type optimizer::count_terms(let code) const {
+
+            if (code.type() == "lambda") {
+                return 1 + count_terms(code.last());
+            }
+
+            if (code.type() != "expression") {
+                return 1;
+            }
+
+            size_type count = 0;
+
+            while (code.is()) {
+                count += count_terms(pop_lead(code));
+            }
+
+            return count;
+        }
+
+} // end Olly
@@ -26,11 +26,42 @@
 namespace Olly {
     namespace eval {
         
-        inline void evaluator::binary_operators(OP_CODE& opr) {
+        inline void evaluator::binary_operators(OP_CODE& opr, const let& site) {
 
             let y = get_expression_from_stack();
             let x = get_expression_from_stack();
 
+            /*
+                Each instruction keeps an inline cache entry of the
+                operand types it last saw.  On a hit the specialized
+                kernel is called directly, else a kernel is looked up
+                for the operands and cached.  Operands without a
+                kernel fall through to the generic 'let' operators.
+            */
+
+            const void* addr = site.cast<op_call>();
+
+            inline_cache& entry = _inline_cache[(reinterpret_cast<std::uintptr_t>(addr) >> 4) % INLINE_CACHE_SIZE];
+
+            const std::type_info& x_type = x.type_id();
+            const std::type_info& y_type = y.type_id();
+
+            if (entry.site == addr && entry.opr == opr && *entry.x == x_type && *entry.y == y_type) {
+
+                set_expression_on_stack(entry.kernel(x, y));
+                return;
+            }
+
+            kernel_type kernel = get_binary_kernel(opr, x, y);
+
+            if (kernel) {
+
+                entry = inline_cache{ addr, opr, &x_type, &y_type, kernel };
+
+                set_expression_on_stack(kernel(x, y));
+                return;
+            }
+
             switch (opr) {
 
             case OP_CODE::AND_op:
@@ -108,5 +139,85 @@ namespace Olly {
             set_expression_on_stack(x);
         }
 
+        inline evaluator::kernel_type evaluator::get_binary_kernel(OP_CODE opr, const let& x, const let& y) {
+            /*
+                Return an unboxed kernel for a binary operator on
+                operands of one type, or a nullptr if the generic
+                operator must be used instead.
+            */
+
+            if (!x.is_type(y)) {
+                return nullptr;
+            }
+
+            if (x.type_id() == typeid(number)) {
+
+                switch (opr) {
+
+                case OP_CODE::ADD_op:
+                    return [](const let& a, const let& b) { return _add_(*a.cast<number>(), *b.cast<number>()); };
+
+                case OP_CODE::SUB_op:
+                    return [](const let& a, const let& b) { return _sub_(*a.cast<number>(), *b.cast<number>()); };
+
+                case OP_CODE::MUL_op:
+                    return [](const let& a, const let& b) { return _mul_(*a.cast<number>(), *b.cast<number>()); };
+
+                case OP_CODE::DIV_op:
+                    return [](const let& a, const let& b) { return _div_(*a.cast<number>(), *b.cast<number>()); };
+
+                case OP_CODE::EQ_op:
+                    return [](const let& a, const let& b) { return let(boolean(_comp_(*a.cast<number>(), *b.cast<number>()) == 0.0)); };
+
+                case OP_CODE::NE_op:
+                    return [](const let& a, const let& b) { return let(boolean(_comp_(*a.cast<number>(), *b.cast<number>()) != 0.0)); };
+
+                case OP_CODE::GT_op:
+                    return [](const let& a, const let& b) { return let(boolean(_comp_(*a.cast<number>(), *b.cast<number>()) > 0.0)); };
+
+                case OP_CODE::GE_op:
+                    return [](const let& a, const let& b) { return let(boolean(_comp_(*a.cast<number>(), *b.cast<number>()) >= 0.0)); };
+
+                case OP_CODE::LT_op:
+                    return [](const let& a, const let& b) { return let(boolean(_comp_(*a.cast<number>(), *b.cast<number>()) < 0.0)); };
+
+                case OP_CODE::LE_op:
+                    return [](const let& a, const let& b) { return let(boolean(_comp_(*a.cast<number>(), *b.cast<number>()) <= 0.0)); };
+
+                default:
+                    return nullptr;
+                }
+            }
+
+            if (x.type_id() == typeid(string)) {
+
+                if (opr == OP_CODE::ADD_op) {
+                    return [](const let& a, const let& b) { return _add_(*a.cast<string>(), *b.cast<string>()); };
+                }
+
+                return nullptr;
+            }
+
+            if (x.type_id() == typeid(boolean)) {
+
+                switch (opr) {
+
+                case OP_CODE::AND_op:
+                    return [](const let& a, const let& b) { return _l_and_(*a.cast<boolean>(), *b.cast<boolean>()); };
+
+                case OP_CODE::OR_op:
+                    return [](const let& a, const let& b) { return _l_or_(*a.cast<boolean>(), *b.cast<boolean>()); };
+
+                case OP_CODE::XOR_op:
+                    return [](const let& a, const let& b) { return _l_xor_(*a.cast<boolean>(), *b.cast<boolean>()); };
+
+                default:
+                    return nullptr;
+                }
+            }
+
+            return nullptr;
+        }
+
     }  // end eval
 } // end Olly
\ No newline at end of file
@@ -0,0 +1,682 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include "evaluator.h"
+
+namespace Olly {
+    namespace eval {
+
+        /********************************************************************************************/
+        //
+        //                                  Collection Operators
+        //
+        //          MAP, FILTER, REDUCE and FOLD apply a lambda across the elements of
+        //          a list, an expression or a range, natively and without a round trip
+        //          through the interpreter for each element.  The collection is taken
+        //          from the stack and the lambda is the next term of the code.
+        //
+        //              [ '1' '2' '3' ] MAP func (x) (x x *)
+        //              [ '1' '2' '3' ] '0' FOLD func (a b) (a + b)
+        //
+        //          A collection never holds nothing, so MAP and parallel give an error
+        //          when a call gives nothing, and their results always line up with the
+        //          elements.
+        //
+        //          A small collection, and any collection whose lambda is not pure, is
+        //          stepped through in order by the calling thread, so a range is never
+        //          held whole and output is written in order.  FOLD always runs this
+        //          way.  Otherwise, as values are immutable, the collection is split in
+        //          to chunks which are run on the shared thread pool, each by an
+        //          evaluator of its own seeded with the variables visible to the call.
+        //          REDUCE combines the results of the chunks pairwise, in order, and so
+        //          expects its lambda to be associative.
+        //
+        //          The limits placed on the calling evaluator hold for those it runs.
+        //          Once any of them is preempted the others stop, the operator gives
+        //          the error naming the limit, and the caller stops before its next
+        //          operator.
+        //
+        /********************************************************************************************/
+
+        inline void evaluator::collection_operators(OP_CODE& opr) {
+
+            if (opr == OP_CODE::parallel_op) {
+                parallel_operator();
+                return;
+            }
+
+            let lam = get_expression_from_code();
+
+            while (lam.type() == "symbol") {
+                lam = get_symbol(lam);
+            }
+
+            let init = (opr == OP_CODE::FOLD_op) ? get_expression_from_stack() : let(nothing());
+            let xs   = get_expression_from_stack();
+
+            if (lam.type() != "lambda") {
+                set_expression_on_stack(error("A collection operator applies a lambda."));
+                return;
+            }
+
+            if (!is_collection(xs)) {
+                set_expression_on_stack(error("A collection operator takes a list, an expression or a range."));
+                return;
+            }
+
+            if (opr == OP_CODE::FOLD_op || xs.size() < PARALLEL_THRESHOLD || !is_pure(lam)) {
+                set_expression_on_stack(stream_collection(opr, lam, init, xs));
+                return;
+            }
+
+            stack_type items;
+
+            get_elements(xs, items);
+
+            map_type scope = visible_scope();
+
+            allowance  own(remaining_operations(), allocated());
+            allowance& shared = _shared ? *_shared : own;
+
+            size_type n = items.size();
+
+            switch (opr) {
+
+            case OP_CODE::MAP_op: {
+
+                stack_type results(n, nothing());
+
+                run_chunks(n, [&](size_type k, size_type lo, size_type hi) {
+
+                    evaluator e(scope, *this, shared);
+
+                    for (size_type i = lo; i < hi && !e.preempted(); ++i) {
+                        results[i] = e.call(lam, { items[i] });
+                    }
+                });
+
+                if (settle(own)) {
+                    set_expression_on_stack(finish());
+                    break;
+                }
+
+                for (const auto& r : results) {
+
+                    if (r.is_nothing()) {
+                        set_expression_on_stack(error("MAP expects its lambda to give a value for each element."));
+                        return;
+                    }
+                }
+
+                set_expression_on_stack(get_collection(xs, results));
+
+            }   break;
+
+            case OP_CODE::FILTER_op: {
+
+                std::vector<char> keep(n, 0);
+
+                run_chunks(n, [&](size_type k, size_type lo, size_type hi) {
+
+                    evaluator e(scope, *this, shared);
+
+                    for (size_type i = lo; i < hi && !e.preempted(); ++i) {
+                        keep[i] = e.call(lam, { items[i] }).is();
+                    }
+                });
+
+                if (settle(own)) {
+                    set_expression_on_stack(finish());
+                    break;
+                }
+
+                stack_type out;
+
+                for (size_type i = 0; i < n; ++i) {
+
+                    if (keep[i]) {
+                        out.push_back(items[i]);
+                    }
+                }
+
+                set_expression_on_stack(get_collection(xs, out));
+
+            }   break;
+
+            case OP_CODE::REDUCE_op: {
+
+                size_type chunks = count_chunks(n);
+
+                stack_type partials(chunks, nothing());
+
+                run_chunks(n, [&](size_type k, size_type lo, size_type hi) {
+
+                    evaluator e(scope, *this, shared);
+
+                    let acc = items[lo];
+
+                    for (size_type i = lo + 1; i < hi && !e.preempted(); ++i) {
+                        acc = e.call(lam, { acc, items[i] });
+                    }
+
+                    partials[k] = acc;
+                });
+
+                {
+                    evaluator e(scope, *this, shared);
+
+                    while (partials.size() > 1 && shared.yield == yield_type::none) {
+                        /*
+                            Combine neighbouring results, so the order
+                            of the elements is kept.
+                        */
+
+                        stack_type next;
+
+                        for (size_type i = 0; i < partials.size() && !e.preempted(); i += 2) {
+
+                            if (i + 1 < partials.size()) {
+                                next.push_back(e.call(lam, { partials[i], partials[i + 1] }));
+                            }
+                            else {
+                                next.push_back(partials[i]);
+                            }
+                        }
+
+                        partials = std::move(next);
+                    }
+                }
+
+                if (settle(own)) {
+                    set_expression_on_stack(finish());
+                    break;
+                }
+
+                set_expression_on_stack(partials.front());
+
+            }   break;
+
+            default:
+                break;
+            }
+        }
+
+        inline let evaluator::stream_collection(OP_CODE opr, const let& lam, const let& init, const let& xs) {
+            /*
+                Apply a lambda across a collection in order on the
+                calling thread, stepping through it rather than
+                gathering it first, so a range is never held whole.
+                This is used for FOLD, for small collections, and
+                for lambdas which are not pure.
+            */
+
+            allowance  own(remaining_operations(), allocated());
+            allowance& shared = _shared ? *_shared : own;
+
+            stack_type out;
+
+            let  acc   = init;
+            bool_type first = (opr == OP_CODE::REDUCE_op);
+            bool_type empty = false;
+
+            {
+                evaluator e(visible_scope(), *this, shared);
+
+                let x = xs;
+
+                while (x.is() && !e.preempted() && !empty) {
+
+                    let item = x.lead();
+
+                    x = x.drop_lead();
+
+                    switch (opr) {
+
+                    case OP_CODE::MAP_op: {
+
+                        let r = e.call(lam, { item });
+
+                        empty = r.is_nothing();
+
+                        out.push_back(r);
+
+                    }   break;
+
+                    case OP_CODE::FILTER_op:
+
+                        if (e.call(lam, { item }).is()) {
+                            out.push_back(item);
+                        }
+                        break;
+
+                    default:
+
+                        if (first) {
+                            acc = item;
+                            first = false;
+                        }
+                        else {
+                            acc = e.call(lam, { acc, item });
+                        }
+                        break;
+                    }
+                }
+
+                take_output(e);
+            }
+
+            if (settle(own)) {
+                return finish();
+            }
+
+            if (empty) {
+                return error("MAP expects its lambda to give a value for each element.");
+            }
+
+            if (opr == OP_CODE::MAP_op || opr == OP_CODE::FILTER_op) {
+                return get_collection(xs, out);
+            }
+
+            return acc;
+        }
+
+        inline void evaluator::parallel_operator() {
+            /*
+                Evaluate each element of the following list as code,
+                and place a list of the results on to the stack.  An
+                element which gives nothing is an error.
+
+                    parallel [ (fib '20') (fib '21') ]
+
+                An element which is pure, and whose estimated cost
+                is at least that of a call, is run as a task on the
+                thread pool by an evaluator of its own.  The other
+                elements are run in order by the calling thread, as
+                spawning a task for them would cost more than it
+                saves, or as they write output.  An element is only
+                pure if every lambda it calls is.
+            */
+
+            let xs = get_expression_from_code();
+
+            while (xs.type() == "symbol") {
+                xs = get_symbol(xs);
+            }
+
+            stack_type items;
+
+            if (!get_elements(xs, items)) {
+                set_expression_on_stack(error("A parallel evaluation takes a list or an expression."));
+                return;
+            }
+
+            map_type scope = visible_scope();
+
+            allowance  own(remaining_operations(), allocated());
+            allowance& shared = _shared ? *_shared : own;
+
+            size_type n = items.size();
+
+            stack_type results(n, nothing());
+
+            std::vector<char> spawned(n, 0);
+
+            std::vector<std::future<void>> tasks;
+
+            for (size_type i = 0; i < n; ++i) {
+
+                if (estimate_cost(items[i]) >= PARALLEL_TASK_COST && is_pure(items[i])) {
+
+                    spawned[i] = 1;
+
+                    tasks.push_back(thread_pool::shared().submit([this, &scope, &shared, &items, &results, i]() {
+
+                        tracer::span traced("eval", "task");
+
+                        evaluator e(scope, *this, shared);
+
+                        results[i] = e.evaluate(items[i]);
+                    }));
+                }
+            }
+
+            evaluator e(scope, *this, shared);
+
+            for (size_type i = 0; i < n; ++i) {
+
+                if (!spawned[i] && !e.preempted()) {
+                    results[i] = e.evaluate(items[i]);
+                }
+            }
+
+            take_output(e);
+
+            for (auto& t : tasks) {
+                thread_pool::shared().wait(t);
+            }
+
+            if (settle(own)) {
+                set_expression_on_stack(finish());
+                return;
+            }
+
+            for (const auto& r : results) {
+
+                if (r.is_nothing()) {
+                    set_expression_on_stack(error("A parallel evaluation expects each element to give a value."));
+                    return;
+                }
+            }
+
+            set_expression_on_stack(get_collection(xs, results));
+        }
+
+        inline size_type evaluator::estimate_cost(const let& code) const {
+            /*
+                Estimate the work of evaluating code by its terms.
+                A call may run any amount of code, and is given the
+                cost of a task.
+            */
+
+            str_type type = code.type();
+
+            if (type == "expression") {
+
+                size_type cost = 0;
+
+                let terms = code;
+
+                while (terms.is()) {
+                    cost += estimate_cost(pop_lead(terms));
+                }
+
+                return cost;
+            }
+
+            if (type == "lambda") {
+                return PARALLEL_TASK_COST;
+            }
+
+            if (type == "symbol") {
+
+                let val = code;
+
+                while (val.type() == "symbol") {
+                    val = get_symbol(val);
+                }
+
+                if (val.type() == "lambda") {
+                    return PARALLEL_TASK_COST;
+                }
+            }
+
+            return 1;
+        }
+
+        inline bool_type evaluator::is_pure(const let& code) const {
+            /*
+                Code is pure when neither it nor any code it reaches
+                writes output or clears the stack or queue.  Unlike
+                'compiler::is_pure', the lambdas and expressions its
+                symbols name in the current scope are followed.
+            */
+
+            std::vector<const void*> seen;
+
+            return is_pure(code, seen);
+        }
+
+        inline bool_type evaluator::is_pure(const let& code, std::vector<const void*>& seen) const {
+
+            str_type type = code.type();
+
+            if (type == "symbol") {
+
+                let var = code;
+                let val = get_symbol(var);
+
+                while (val.type() == "symbol") {
+                    val = get_symbol(val);
+                }
+
+                return is_pure(val, seen);
+            }
+
+            if (type == "lambda" || type == "expression") {
+                /*
+                    Each lambda and expression is walked once, so
+                    recursion ends.
+                */
+
+                const void* id = (type == "lambda") ? static_cast<const void*>(code.cast<lambda>()) : static_cast<const void*>(code.cast<expression>());
+
+                if (std::find(seen.cbegin(), seen.cend(), id) != seen.cend()) {
+                    return true;
+                }
+
+                seen.push_back(id);
+
+                let terms = (type == "lambda") ? code.last() : code;
+
+                while (terms.is()) {
+
+                    if (!is_pure(pop_lead(terms), seen)) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            if (type == "op_call") {
+
+                if (!compiler::is_pure(code)) {
+                    return false;
+                }
+
+                let args = code.lead();
+
+                return args.is_nothing() || is_pure(args, seen);
+            }
+
+            return true;
+        }
+
+        inline bool_type evaluator::is_collection(const let& xs) const {
+            /*
+                Generated sequences are stepped by calling their
+                lambda, and so can not be walked here.
+            */
+
+            str_type type = xs.type();
+
+            if (type == "sequence" && xs.cast<sequence>()->generator().is_something()) {
+                return false;
+            }
+
+            return type == "list" || type == "expression" || type == "sequence";
+        }
+
+        inline bool_type evaluator::get_elements(const let& xs, stack_type& items) const {
+            /*
+                A collection is gathered whole before any call is
+                made, so that it can be split in to chunks.
+            */
+
+            if (!is_collection(xs)) {
+                return false;
+            }
+
+            let x = xs;
+
+            while (x.is()) {
+
+                items.push_back(x.lead());
+
+                x = x.drop_lead();
+            }
+
+            return true;
+        }
+
+        inline let evaluator::get_collection(const let& xs, const stack_type& items) const {
+            /*
+                An expression is returned as an expression, and any
+                other collection as a list.
+            */
+
+            let result = (xs.type() == "expression") ? let(expression()) : let(list());
+
+            for (auto i = items.crbegin(); i != items.crend(); ++i) {
+                result = result.place_lead(*i);
+            }
+
+            return result;
+        }
+
+        inline evaluator::map_type evaluator::visible_scope() const {
+
+            map_type scope;
+
+            for (const auto& vars : _variables) {
+
+                for (const auto& v : vars) {
+                    scope[v.first] = v.second;
+                }
+            }
+
+            return scope;
+        }
+
+        inline let evaluator::call(const let& lam, std::initializer_list<let> args) {
+            /*
+                Call a lambda with its arguments.
+            */
+
+            let code = expression();
+
+            for (auto i = std::rbegin(args); i != std::rend(args); ++i) {
+                code = code.place_lead(*i);
+            }
+
+            return evaluate(code.place_lead(lam));
+        }
+
+        inline let evaluator::evaluate(const let& code) {
+            /*
+                Evaluate code and return the top of the stack it
+                leaves, or nothing.  The stack is left as it was.
+                An evaluation preempted by a limit returns the
+                error naming it, and tells its siblings to stop.
+            */
+
+            size_type height = _stack.size();
+
+            let exp = (code.type() == "expression") ? code : let(expression(code));
+
+            _code.emplace_back(code_frame{ exp, 0 });
+
+            eval();
+
+            if (_shared && _limits.allocation) {
+                allocated();    // Add the bytes allocated since the last check to the allowance.
+            }
+
+            if (preempted()) {
+
+                yield_type none = yield_type::none;
+
+                if (_shared) {
+                    _shared->yield.compare_exchange_strong(none, _yield);
+                }
+
+                return finish();
+            }
+
+            let result = nothing();
+
+            if (_stack.size() > height) {
+                result = _stack.back();
+            }
+
+            _stack.resize(height);
+
+            return result;
+        }
+
+        inline size_type evaluator::count_chunks(size_type n) {
+
+            if (n < PARALLEL_THRESHOLD) {
+                return 1;
+            }
+
+            return std::max<size_type>(std::min(thread_pool::shared().size(), n / PARALLEL_GRAIN), 1);
+        }
+
+        inline void evaluator::run_chunks(size_type n, const chunk_type& work) {
+            /*
+                Split the range [0, n) in to chunks of near equal
+                size, and run the work on each with its index.  The
+                first chunk is run in the calling thread while the
+                others run on the pool.
+            */
+
+            size_type chunks = count_chunks(n);
+
+            if (chunks < 2) {
+
+                if (n) {
+                    work(0, 0, n);
+                }
+
+                return;
+            }
+
+            std::vector<std::future<void>> results;
+
+            for (size_type k = 1; k < chunks; ++k) {
+
+                size_type lo = k * n / chunks;
+                size_type hi = (k + 1) * n / chunks;
+
+                results.push_back(thread_pool::shared().submit([&work, k, lo, hi]() {
+
+                    tracer::span traced("eval", "chunk");
+
+                    work(k, lo, hi);
+                }));
+            }
+
+            {
+                tracer::span traced("eval", "chunk");
+
+                work(0, 0, n / chunks);
+            }
+
+            for (auto& r : results) {
+                thread_pool::shared().wait(r);
+            }
+        }
+
+    }  // end eval
+} // end Olly
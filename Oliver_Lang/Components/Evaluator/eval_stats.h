@@ -0,0 +1,163 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include <atomic>
+
+#include "histogram.h"
+
+namespace Olly {
+    namespace eval {
+
+        /********************************************************************************************/
+        //
+        //                                'eval_stats' class definition
+        //
+        //        The eval_stats class keeps histograms of each call to an evaluator's
+        //        'eval' or 'resume': its wall time, the operators it ran, the deepest
+        //        the stack and the return stack grew, and the bytes of values it made.
+        //
+        //        Only the evaluator's thread records.  Any thread may read a snapshot
+        //        or ask for the histograms to be cleared.  A snapshot is copied under
+        //        a sequence count, and copied again if a call was recorded meanwhile.
+        //        A clear is carried out by the evaluator's thread, before it records
+        //        its next call, so recording takes no lock.
+        //
+        /********************************************************************************************/
+
+        class eval_stats {
+        public:
+
+            typedef     histogram::value_type   value_type;
+
+            struct snapshot {
+                histogram   latency;        // Nanoseconds.
+                histogram   operations;
+                histogram   stack;          // The deepest stack.
+                histogram   returns;        // The deepest return stack.
+                histogram   bytes;          // Bytes of values made.
+
+                str_type report() const;
+            };
+
+        private:
+
+            snapshot                    _data;
+            std::atomic<std::uint64_t>  _sequence;  // Odd while a call is being recorded.
+            std::atomic<bool_type>      _clear;
+
+        public:
+
+            eval_stats();
+            virtual ~eval_stats();
+
+            void record(value_type latency, value_type operations, value_type stack, value_type returns, value_type bytes);
+
+            snapshot read() const;
+            void clear();
+
+        private:
+
+            eval_stats(const eval_stats& obj) = delete;
+        };
+
+
+
+        eval_stats::eval_stats() : _data(), _sequence(0), _clear(false) {
+        }
+
+        eval_stats::~eval_stats() {
+        }
+
+        inline void eval_stats::record(value_type latency, value_type operations, value_type stack, value_type returns, value_type bytes) {
+
+            std::uint64_t s = _sequence.load(std::memory_order_relaxed);
+
+            _sequence.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            if (_clear.exchange(false, std::memory_order_acquire)) {
+                _data.latency.clear();
+                _data.operations.clear();
+                _data.stack.clear();
+                _data.returns.clear();
+                _data.bytes.clear();
+            }
+
+            _data.latency.record(latency);
+            _data.operations.record(operations);
+            _data.stack.record(stack);
+            _data.returns.record(returns);
+            _data.bytes.record(bytes);
+
+            _sequence.store(s + 2, std::memory_order_release);
+        }
+
+        inline eval_stats::snapshot eval_stats::read() const {
+            /*
+                A clear asked for and not yet carried out is shown
+                as empty histograms.
+            */
+
+            snapshot copy;
+
+            if (_clear.load(std::memory_order_acquire)) {
+                return copy;
+            }
+
+            while (true) {
+
+                std::uint64_t before = _sequence.load(std::memory_order_acquire);
+
+                if (before & 1) {
+                    continue;
+                }
+
+                copy = _data;
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (_sequence.load(std::memory_order_relaxed) == before) {
+                    return copy;
+                }
+            }
+        }
+
+        inline void eval_stats::clear() {
+            _clear.store(true, std::memory_order_release);
+        }
+
+        inline str_type eval_stats::snapshot::report() const {
+
+            stream_type out;
+
+            out << "latency:    " << latency.report("ns") << std::endl;
+            out << "operations: " << operations.report("") << std::endl;
+            out << "stack:      " << stack.report("") << std::endl;
+            out << "return:     " << returns.report("") << std::endl;
+            out << "bytes:      " << bytes.report("B") << std::endl;
+
+            return out.str();
+        }
+
+    }  // end eval
+} // end Olly
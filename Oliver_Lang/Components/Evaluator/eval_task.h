@@ -0,0 +1,154 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+#include "../Compiler/compiler.h"
+
+namespace Olly {
+    namespace eval {
+
+        /********************************************************************************************/
+        //
+        //                                 'eval_task' class definition
+        //
+        //        The eval_task class is the coroutine returned by 'eval_async'.  It
+        //        does nothing until it is first resumed, and each call to 'resume'
+        //        then runs the evaluation until it next suspends or completes.  The
+        //        result is the stack left by the program once the task is done.
+        //
+        /********************************************************************************************/
+
+        class eval_task {
+        public:
+
+            struct promise_type {
+
+                let                 value;
+                std::exception_ptr  exception;
+
+                promise_type() : value(), exception() {
+                }
+
+                eval_task get_return_object() {
+                    return eval_task(std::coroutine_handle<promise_type>::from_promise(*this));
+                }
+
+                std::suspend_always initial_suspend() noexcept { return {}; }
+                std::suspend_always   final_suspend() noexcept { return {}; }
+
+                void return_value(let result) {
+                    value = result;
+                }
+
+                void unhandled_exception() {
+                    exception = std::current_exception();
+                }
+            };
+
+            typedef     std::coroutine_handle<promise_type>     handle_type;
+
+            eval_task(eval_task&& obj) noexcept;
+            virtual ~eval_task();
+
+            eval_task& operator = (eval_task&& obj) noexcept;
+
+            bool_type resume();
+            bool_type done() const;
+            let result() const;
+
+        private:
+
+            handle_type _handle;
+
+            explicit eval_task(handle_type handle);
+
+            eval_task(const eval_task& obj) = delete;
+        };
+
+
+
+        eval_task::eval_task(handle_type handle) : _handle(handle) {
+        }
+
+        eval_task::eval_task(eval_task&& obj) noexcept : _handle(std::exchange(obj._handle, nullptr)) {
+        }
+
+        eval_task::~eval_task() {
+
+            if (_handle) {
+                _handle.destroy();
+            }
+        }
+
+        inline eval_task& eval_task::operator = (eval_task&& obj) noexcept {
+
+            if (this != &obj) {
+
+                if (_handle) {
+                    _handle.destroy();
+                }
+
+                _handle = std::exchange(obj._handle, nullptr);
+            }
+
+            return *this;
+        }
+
+        inline bool_type eval_task::resume() {
+            /*
+                Run to the next suspension, and return true while
+                there is more to run.  An exception thrown by the
+                evaluation is thrown again here.
+            */
+
+            if (!_handle || _handle.done()) {
+                return false;
+            }
+
+            _handle.resume();
+
+            if (_handle.promise().exception) {
+                std::rethrow_exception(_handle.promise().exception);
+            }
+
+            return !_handle.done();
+        }
+
+        inline bool_type eval_task::done() const {
+            return !_handle || _handle.done();
+        }
+
+        inline let eval_task::result() const {
+
+            if (!done() || !_handle) {
+                return nothing();
+            }
+
+            return _handle.promise().value;
+        }
+
+    }  // end eval
+} // end Olly
@@ -22,6 +22,18 @@
 /********************************************************************************************/
 
 #include "../Compiler/compiler.h"
+#include "jit.h"
+#include "memo_cache.h"
+#include "histogram.h"
+#include "eval_stats.h"
+#include "heap_snapshot.h"
+#include "profiler.h"
+#include "thread_pool.h"
+#include "eval_task.h"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
 
 namespace Olly {
     namespace eval {
@@ -55,38 +67,238 @@ namespace Olly {
 
         class evaluator {
 
-            typedef     std::map<str_type, let>  map_type;
+            struct code_frame {
+                /*
+                    A cursor in to a code expression.  Expressions
+                    are cons lists, so the cursor is the remaining
+                    tail of the body and advancing it allocates
+                    nothing.  'pending' counts the operations which
+                    have been scheduled on to the frame and are held
+                    on the top of '_pending'.
+                */
+                let         body;
+                size_type   pending;
+            };
+
+            struct memo_frame {
+                /*
+                    A call to a memoized lambda which is running.
+                    Its result is what it leaves on the stack above
+                    'height', provided it took nothing from below.
+                */
+                let                         lam;
+                memo_cache::values_type     args;
+                size_type                   height;
+                size_type                   floor;
+            };
+
+            typedef     let (*kernel_type)(const let& x, const let& y);
+
+            struct inline_cache {
+                /*
+                    The operand types last seen by a binary operator
+                    instruction, and the kernel specialized for them.
+                */
+                const void*             site;
+                OP_CODE                 opr;
+                const std::type_info*   x;
+                const std::type_info*   y;
+                kernel_type             kernel;
+            };
+
+            typedef     Olly::map_type           map_type;
             typedef     std::vector<let>	     stack_type;
             typedef     std::vector<map_type>	 closure_type;
+            typedef     std::vector<code_frame>  code_type;
+            typedef     std::vector<inline_cache> cache_type;
+            typedef     std::map<str_type, size_type> ngram_type;
+            typedef     std::vector<memo_frame>  memo_type;
+            typedef     std::function<void(size_type k, size_type lo, size_type hi)> chunk_type;
 
             closure_type                _variables;
             stack_type                      _stack;
             stack_type                     _return;
-            stack_type                       _code;
+            code_type                        _code;
+            stack_type                     _pending;
+            cache_type                _inline_cache;
             size_type              _max_stack_size;
 
+            size_type                _ngram_length;  // The longest n-gram counted, or zero when not counting.
+            std::vector<str_type>    _ngram_window;
+            ngram_type                     _ngrams;
+
+            memo_cache                       _memo;
+            memo_type                 _memo_frames;
+            size_type                 _stack_floor;  // The lowest height of the stack since the last memoized call began.
+
+#if OLIVER_JIT
+            jit                               _jit;
+            std::exception_ptr          _jit_error;  // Thrown by a helper, to be thrown again once the compiled code returns.
+#endif
+
+        public:
+
+            enum class yield_type {
+                none,       // The evaluation has not suspended.
+                budget,     // The operators allowed in a slice have run.
+                output,     // An operator has written output.
+                operations, // Preempted by the limit on operators run.
+                deadline,   // Preempted by the limit on time.
+                memory,     // Preempted by the limit on bytes of values made.
+            };
+
+            struct limits {
+                /*
+                    The limits placed on each call to 'eval' or
+                    'resume'.  A limit of zero is no limit.
+                */
+                size_type                   operations;
+                std::chrono::nanoseconds    time;
+                size_type                   allocation;
+            };
+
+            struct capacity {
+                /*
+                    The room made by 'preallocate' for a program
+                    run again and again without allocating.
+                */
+                size_type                   stack;      // Values on the stack and on the return stack.
+                size_type                   code;       // Frames of code.
+                size_type                   scopes;     // Nested scopes.
+                size_type                   objects;    // Blocks of each size kept by the object pool.
+                size_type                   output;     // Bytes of output buffered between flushes.
+            };
+
+        private:
+
+            typedef     std::chrono::steady_clock   clock_type;
+
+            struct allowance {
+                /*
+                    The limits shared by the evaluators which a
+                    collection operator runs, and by any which
+                    those run in turn.
+                */
+                allowance(size_type ops, std::int64_t used) : granted(ops), operations(ops), yield(yield_type::none),
+                    used(used), bytes(0), base(let::live_bytes()) {
+                }
+
+                size_type                   granted;    // The operators left to the evaluator running the operator.
+                std::atomic<size_type>      operations; // The operators left, or UNLIMITED.
+                std::atomic<yield_type>     yield;      // The first limit reached by any of them.
+
+                std::int64_t                used;       // The bytes allocated by the evaluator running the operator before it began.
+                std::atomic<std::int64_t>   bytes;      // The bytes allocated by the evaluators it runs, each on its own thread.
+                std::int64_t                base;       // The bytes live on the thread running the operator as it began.
+            };
+
+            size_type                   _countdown;  // The operators left before the dispatch loop checks whether to suspend.
+            size_type                      _period;  // The operators between the last two checks.
+            size_type                     _ops_run;  // The operators run by this call, up to the last check.
+            size_type                       _slice;
+            size_type                  _slice_left;
+            bool_type                       _async;
+            yield_type                      _yield;
+
+            limits                         _limits;
+            size_type                    _ops_left;
+            clock_type::time_point       _deadline;
+            std::int64_t               _alloc_base;  // The bytes live on this thread when the allowance began.
+            std::int64_t               _alloc_told;  // The bytes added to '_shared->bytes' so far.
+            std::int64_t              _alloc_child;  // The bytes allocated by the evaluators run by collection operators.
+            allowance*                     _shared;  // Set in an evaluator run by a collection operator of a limited one.
+
+            bool_type                    _buffered;  // Output is written to '_output' in place of std::cout.
+            str_type                       _output;
+            stream_type                       _out;
+
+#if OLIVER_PROFILE
+            bool_type                   _profiling;
+            profiler                     _profiler;
+#endif
+
+            struct traced_call {
+                str_type                    name;
+                tracer::tick_type           start;
+                size_type                   depth;      // The depth of the call's scope.
+            };
+
+            bool_type               _tracing_calls;
+            std::vector<traced_call> _traced_calls;
+
+            std::unique_ptr<eval_stats>     _stats;  // Made by 'enable_stats'.
+            clock_type::time_point    _stats_start;
+            std::uint64_t             _stats_bytes;
+            size_type                  _stack_peak;
+            size_type                 _return_peak;
+
         public:
             static const size_type DEFAULT_STACK_LIMIT;
+            static const size_type INLINE_CACHE_SIZE;
+            static const size_type PARALLEL_THRESHOLD;
+            static const size_type PARALLEL_GRAIN;
+            static const size_type PARALLEL_TASK_COST;
+            static const size_type CHECK_PERIOD;
+            static const size_type UNLIMITED;
+            static const capacity  DEFAULT_CAPACITY;
 
             evaluator();
             evaluator(evaluator& env) = delete;
 
             let eval(let exp);
+            let resume();
+            void reset();
+
+            void set_limits(const limits& lim);
+            bool_type preempted() const;
+
+#if OLIVER_PROFILE
+            void enable_profiling();
+            const profiler& profile() const;
+#endif
+            bool_type profiling() const;
 
+            void enable_stats();
+            eval_stats::snapshot stats() const;
+            void clear_stats();
+
+            void snapshot_heap(heap_snapshot& snap) const;
+
+            void preallocate(const capacity& cap);
+            const str_type& output() const;
+            void flush_output();
+
+            eval_task eval_async(let exp, size_type slice);
+            yield_type yielded() const;
+
+            void collect_ngrams(size_type length);
+            str_type ngram_report(size_type top) const;
+
+            size_type memo_hits() const;
+            size_type memo_misses() const;
+
+            size_type jit_compiled() const;
+            size_type jit_evicted() const;
 
         private:
 
             // let eval(let exp, closure_type& vars);
 
+            evaluator(const map_type& scope, const evaluator& parent, allowance& shared);
+
             void define_enclosure(let& lam);
             void define_enclosure();
             void delete_enclosure();
+            bool_type reuse_enclosure();
+
+            bool_type is_tail_call() const;
 
             void   set_expression_on_code(let exp);
             void  set_expression_on_stack(let exp);
             void set_expression_on_return(let exp);
 
             let get_result_stack() const;
+            static let get_let_stats();
             let get_result_queue();
             let get_eval_queue() const;
 
@@ -96,14 +308,83 @@ namespace Olly {
             let get_expression_from_return();
             let get_expression_from_stack();
             let get_expression_from_code();
+            let peek_expression_from_code() const;
+
+            static const let& get_op_call(OP_CODE opr);
 
             void eval();
+            void dispatch(OP_CODE opr, const let& site);
+
+            void arm();
+            size_type next_period() const;
+            size_type operations_run() const;
+            bool_type suspend();
+            void yield_on_output();
+            let finish() const;
+            bool_type limited() const;
+            size_type remaining_operations() const;
+            std::int64_t allocated();
+            bool_type settle(const allowance& own);
+            void take_output(evaluator& child);
+
+            void emit(const let& val);
+            void emit_line();
+
+            void begin_stats();
+            void end_stats();
+
+            void trace_enter(const str_type& name);
+            void trace_leave(size_type depth);
 
             void fundamental_operators(OP_CODE& opr);
-            void    sequence_operators(OP_CODE& opr);
+            void    sequence_operators(OP_CODE& opr, const let& site);
             void associative_operators(OP_CODE& opr);
             void       unary_operators(OP_CODE& opr);
-            void      binary_operators(OP_CODE& opr);
+            void      binary_operators(OP_CODE& opr, const let& site);
+
+            static kernel_type get_binary_kernel(OP_CODE opr, const let& x, const let& y);
+            void    function_operators(OP_CODE& opr);
+            void       super_operators(OP_CODE& opr, const let& site);
+            void               unfuse(const let& site);
+            void  collection_operators(OP_CODE& opr);
+
+            void  drop_lead(const let& x);
+
+            let  stream_collection(OP_CODE opr, const let& lam, const let& init, const let& xs);
+
+            bool_type is_collection(const let& xs) const;
+            bool_type get_elements(const let& xs, stack_type& items) const;
+            let     get_collection(const let& xs, const stack_type& items) const;
+            map_type visible_scope() const;
+            let call(const let& lam, std::initializer_list<let> args);
+            let evaluate(const let& code);
+
+            void parallel_operator();
+            size_type estimate_cost(const let& code) const;
+            bool_type is_pure(const let& code) const;
+            bool_type is_pure(const let& code, std::vector<const void*>& seen) const;
+
+            static size_type count_chunks(size_type n);
+            static void run_chunks(size_type n, const chunk_type& work);
+
+            void count_ngrams(const let& exp);
+
+#if OLIVER_JIT
+            bool_type run_compiled(const let& body);
+
+            static jit::helper_type jit_template(const let& term);
+
+            template<jit::helper_type helper>
+            static bool_type jit_guard(evaluator* e, const let* term) noexcept;
+
+            static bool_type jit_push(evaluator* e, const let* term);
+            static bool_type jit_symbol(evaluator* e, const let* term);
+            static bool_type jit_binary(evaluator* e, const let* term);
+            static bool_type jit_operator(evaluator* e, const let* term);
+            static bool_type jit_drop_lead(evaluator* e, const let* term);
+            static bool_type jit_symbol_add(evaluator* e, const let* term);
+            static bool_type jit_let_const(evaluator* e, const let* term);
+#endif
         };
 
         /********************************************************************************************/
@@ -113,8 +394,66 @@ namespace Olly {
         /********************************************************************************************/
 
         const size_type evaluator::DEFAULT_STACK_LIMIT = 2048;
+        const size_type evaluator::INLINE_CACHE_SIZE   = 256;
+        const size_type evaluator::PARALLEL_THRESHOLD  = 4096;   // The fewest elements split across threads.
+        const size_type evaluator::PARALLEL_GRAIN      = 1024;   // The fewest elements in each chunk.
+        const size_type evaluator::PARALLEL_TASK_COST  = 32;     // The least estimated cost of code run as a task.
+        const size_type evaluator::CHECK_PERIOD        = 1024;   // The most operators run between checks of the time and bytes limits.
+        const size_type evaluator::UNLIMITED           = std::numeric_limits<size_type>::max() / 2;
+
+        const evaluator::capacity evaluator::DEFAULT_CAPACITY = { 4096, 1024, 256, 1024, 1 << 16 };
+
+        evaluator::evaluator() : _variables(), _stack(), _return(), _code(), _pending(),
+            _inline_cache(INLINE_CACHE_SIZE, inline_cache{ nullptr, OP_CODE::NOTHING_OP, nullptr, nullptr, nullptr }), _max_stack_size(DEFAULT_STACK_LIMIT),
+            _ngram_length(0), _ngram_window(), _ngrams(),
+            _memo(), _memo_frames(), _stack_floor(std::numeric_limits<size_type>::max()),
+            _countdown(UNLIMITED), _period(UNLIMITED), _ops_run(0), _slice(0), _slice_left(UNLIMITED), _async(false), _yield(yield_type::none),
+            _limits{ 0, std::chrono::nanoseconds(0), 0 }, _ops_left(UNLIMITED), _deadline(), _alloc_base(0), _alloc_told(0), _alloc_child(0), _shared(nullptr),
+            _buffered(false), _output(), _out()
+#if OLIVER_PROFILE
+            , _profiling(false), _profiler()
+#endif
+            , _tracing_calls(false), _traced_calls(),
+            _stats(), _stats_start(), _stats_bytes(0), _stack_peak(0), _return_peak(0) {
+
+            _code.reserve(_max_stack_size);
+            _pending.reserve(_max_stack_size);
+        }
+
+        evaluator::evaluator(const map_type& scope, const evaluator& parent, allowance& shared) : evaluator() {
+            /*
+                An evaluator run by a collection operator sees the
+                variables visible to the call.  The limits of its
+                parent hold for it too, checked against the same
+                deadline and allocation, with its operators and
+                bytes drawn from an allowance shared by its
+                siblings.  The bytes it allocates are counted on
+                the thread which runs it, which is the thread it
+                is made on.  Its output is buffered if its
+                parent's is.
+            */
+
+            _variables.emplace_back(scope);
+
+            if (parent.limited()) {
+
+                _limits     = parent._limits;
+                _deadline   = parent._deadline;
+                _alloc_base = let::live_bytes();
+                _shared     = &shared;
+                _ops_left   = shared.operations;
+
+                _period    = next_period();
+                _countdown = _period + 1;
+            }
+
+            if (parent._buffered) {
 
-        evaluator::evaluator() : _variables(), _stack(), _return(), _code(), _max_stack_size(DEFAULT_STACK_LIMIT) {
+                _out.str(str_type(64, ' '));
+                _out << std::boolalpha;
+
+                _buffered = true;
+            }
         }
 
         inline let evaluator::eval(let exp) {
@@ -123,15 +462,437 @@ namespace Olly {
                 return nothing();
             }
 
+            tracer::span traced("eval", "eval");
+
+            if (_stats) {
+                begin_stats();
+            }
+
             exp = unwrap_expresion(exp);
 
-            _code.emplace_back(exp);
+            _code.emplace_back(code_frame{ exp, 0 });
 
             define_enclosure();
 
+            _tracing_calls = tracer::tracing_calls();
+
+#if OLIVER_PROFILE
+            if (_profiling) {
+                _profiler.begin();
+            }
+#endif
+
+            arm();
+
             eval();
 
-            return get_result_stack();
+            if (_tracing_calls && _code.empty()) {
+                trace_leave(0);
+            }
+
+#if OLIVER_PROFILE
+            if (_profiling && _code.empty()) {
+                _profiler.end();
+            }
+#endif
+
+            if (_stats) {
+                end_stats();
+            }
+
+            return finish();
+        }
+
+        inline let evaluator::resume() {
+            /*
+                Continue an evaluation which was preempted, with a
+                fresh allowance of each limit.
+            */
+
+            if (_code.empty()) {
+                return get_result_stack();
+            }
+
+            tracer::span traced("eval", "resume");
+
+            if (_stats) {
+                begin_stats();
+            }
+
+            arm();
+
+            eval();
+
+            if (_tracing_calls && _code.empty()) {
+                trace_leave(0);
+            }
+
+#if OLIVER_PROFILE
+            if (_profiling && _code.empty()) {
+                _profiler.end();
+            }
+#endif
+
+            if (_stats) {
+                end_stats();
+            }
+
+            return finish();
+        }
+
+        inline void evaluator::set_limits(const limits& lim) {
+            _limits = lim;
+        }
+
+        inline bool_type evaluator::preempted() const {
+            return _yield == yield_type::operations || _yield == yield_type::deadline || _yield == yield_type::memory;
+        }
+
+#if OLIVER_PROFILE
+        inline void evaluator::enable_profiling() {
+            /*
+                Compiled lambda bodies run outside the dispatch
+                loop, so the JIT is left unused while profiling.
+            */
+
+            _profiling = true;
+        }
+
+        inline const profiler& evaluator::profile() const {
+            return _profiler;
+        }
+#endif
+
+        inline bool_type evaluator::profiling() const {
+#if OLIVER_PROFILE
+            return _profiling;
+#else
+            return false;
+#endif
+        }
+
+        inline void evaluator::enable_stats() {
+            /*
+                Record each call to 'eval' and 'resume' from now on.
+            */
+
+            if (!_stats) {
+                _stats = std::make_unique<eval_stats>();
+            }
+        }
+
+        inline eval_stats::snapshot evaluator::stats() const {
+            return _stats ? _stats->read() : eval_stats::snapshot();
+        }
+
+        inline void evaluator::clear_stats() {
+
+            if (_stats) {
+                _stats->clear();
+            }
+        }
+
+        inline void evaluator::snapshot_heap(heap_snapshot& snap) const {
+            /*
+                Add the variables of each scope, the stacks and the
+                code still to run to a heap snapshot, as its roots.
+                The variables of an inner scope are labelled with
+                the depth of their scope.
+            */
+
+            for (size_type i = 0; i < _variables.size(); ++i) {
+
+                for (const auto& var : _variables[i]) {
+                    snap.add_root(i ? var.first + "@" + std::to_string(i) : var.first, var.second);
+                }
+            }
+
+            for (size_type i = 0; i < _stack.size(); ++i) {
+                snap.add_root("stack[" + std::to_string(i) + "]", _stack[i]);
+            }
+
+            for (size_type i = 0; i < _return.size(); ++i) {
+                snap.add_root("return[" + std::to_string(i) + "]", _return[i]);
+            }
+
+            for (size_type i = 0; i < _code.size(); ++i) {
+                snap.add_root("code[" + std::to_string(i) + "]", _code[i].body);
+            }
+        }
+
+        inline void evaluator::begin_stats() {
+
+            _stats_start = clock_type::now();
+            _stats_bytes = let::made_bytes();
+
+            _stack_peak  = _stack.size();
+            _return_peak = _return.size();
+        }
+
+        inline void evaluator::end_stats() {
+
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - _stats_start);
+
+            _stats->record(elapsed.count(), operations_run(), _stack_peak, _return_peak, let::made_bytes() - _stats_bytes);
+        }
+
+        inline void evaluator::preallocate(const capacity& cap) {
+            /*
+                Make room for the stacks, the scopes, the objects
+                and the output of a program, so that once it has
+                run, running it again makes no allocation.  Output
+                is then buffered until 'flush_output'.
+            */
+
+            _stack.reserve(cap.stack);
+            _return.reserve(cap.stack);
+            _code.reserve(cap.code);
+            _pending.reserve(cap.code);
+            _variables.reserve(cap.scopes);
+            _memo_frames.reserve(cap.scopes);
+
+            for (size_type bytes = object_pool::ALIGNMENT; bytes <= object_pool::SIZES * object_pool::ALIGNMENT; bytes += object_pool::ALIGNMENT) {
+                object_pool::reserve(bytes, cap.objects);
+            }
+
+            _output.reserve(cap.output);
+
+            _out.str(str_type(64, ' '));    // Values are formatted in place of the spaces.
+            _out << std::boolalpha;
+
+            _buffered = true;
+        }
+
+        inline void evaluator::trace_enter(const str_type& name) {
+            /*
+                A call is traced from when its scope is made until
+                the scope at the same depth is deleted.  A tail call
+                takes over its caller's scope, and so ends its
+                caller's call.
+            */
+
+            size_type depth = _variables.size();
+
+            trace_leave(depth);
+
+            _traced_calls.push_back(traced_call{ name.empty() ? "lambda" : name, tracer::now(), depth });
+        }
+
+        inline void evaluator::trace_leave(size_type depth) {
+
+            while (!_traced_calls.empty() && _traced_calls.back().depth >= depth) {
+
+                const traced_call& c = _traced_calls.back();
+
+                tracer::complete("call", c.name.c_str(), c.start, tracer::now());
+
+                _traced_calls.pop_back();
+            }
+        }
+
+        inline const str_type& evaluator::output() const {
+            return _output;
+        }
+
+        inline void evaluator::flush_output() {
+
+            std::cout.write(_output.data(), _output.size());
+
+            _output.clear();
+        }
+
+        inline void evaluator::emit(const let& val) {
+            /*
+                Buffered output formats a value over the last one,
+                so neither the stream nor the buffer grows once
+                they have held the longest value and output.
+            */
+
+            if (!_buffered) {
+                std::cout << str(val);
+                return;
+            }
+
+            _out.seekp(0);
+
+            if (val.type() == "format") {
+                val.repr(_out);
+            }
+            else {
+                val.str(_out);
+            }
+
+            _output.append(_out.view().data(), static_cast<size_type>(_out.tellp()));
+        }
+
+        inline void evaluator::emit_line() {
+
+            if (!_buffered) {
+                std::cout << std::endl;
+                return;
+            }
+
+            _output += '\n';
+        }
+
+        inline eval_task evaluator::eval_async(let exp, size_type slice) {
+            /*
+                Evaluate a program as a coroutine.  The task suspends
+                at the boundary between two operators once 'slice'
+                operators have run since it was resumed, or once an
+                operator has written output.  A slice of zero is not
+                limited.  The evaluator must outlive the task.
+            */
+
+            if (exp.type() != "expression") {
+                co_return nothing();
+            }
+
+            _code.emplace_back(code_frame{ unwrap_expresion(exp), 0 });
+
+            define_enclosure();
+
+            _async = true;
+            _slice = slice;
+
+            while (!_code.empty()) {
+
+                arm();
+
+                {
+                    tracer::span traced("eval", "slice");
+
+                    eval();
+                }
+
+                if (!_code.empty()) {
+                    co_await std::suspend_always();
+                }
+            }
+
+            _async = false;
+            _slice = 0;
+
+            co_return get_result_stack();
+        }
+
+        inline evaluator::yield_type evaluator::yielded() const {
+            return _yield;
+        }
+
+        inline void evaluator::reset() {
+            /*
+                Forget the state of the last program run, keeping
+                the compiled lambdas and memoized results which
+                other programs may reuse.
+            */
+
+            _variables.clear();
+            _stack.clear();
+            _return.clear();
+            _code.clear();
+            _pending.clear();
+            _memo_frames.clear();
+            _ngram_window.clear();
+            _traced_calls.clear();
+
+            _stack_floor = std::numeric_limits<size_type>::max();
+            _countdown   = UNLIMITED;
+            _period      = UNLIMITED;
+            _slice       = 0;
+            _async       = false;
+            _yield       = yield_type::none;
+        }
+
+        inline size_type evaluator::memo_hits() const {
+            return _memo.hits();
+        }
+
+        inline size_type evaluator::memo_misses() const {
+            return _memo.misses();
+        }
+
+        inline size_type evaluator::jit_compiled() const {
+#if OLIVER_JIT
+            return _jit.compiled();
+#else
+            return 0;
+#endif
+        }
+
+        inline size_type evaluator::jit_evicted() const {
+#if OLIVER_JIT
+            return _jit.evicted();
+#else
+            return 0;
+#endif
+        }
+
+        inline void evaluator::collect_ngrams(size_type length) {
+            /*
+                Count each sequence of up to 'length' consecutive
+                terms dispatched by the evaluator.  A length of less
+                than two stops the counting.
+            */
+
+            _ngram_length = length < 2 ? 0 : length;
+            _ngram_window.clear();
+        }
+
+        inline str_type evaluator::ngram_report(size_type top) const {
+
+            std::vector<std::pair<size_type, str_type>> ranked;
+
+            for (const auto& n : _ngrams) {
+                ranked.emplace_back(n.second, n.first);
+            }
+
+            std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+                return a.first > b.first;
+                });
+
+            stream_type out;
+
+            out << "opcode n-grams:\n";
+
+            for (size_type i = 0; i < ranked.size() && i < top; ++i) {
+
+                out.width(12);
+                out << ranked[i].first << "  " << ranked[i].second << "\n";
+            }
+
+            return out.str();
+        }
+
+        inline void evaluator::count_ngrams(const let& exp) {
+            /*
+                Operators are named by their op code alone, and any
+                other term by its type.
+            */
+
+            str_type name;
+
+            if (exp.type() == "op_call") {
+                name = str(op_call(exp.op_code()));
+            }
+            else {
+                name = "<" + exp.type() + ">";
+            }
+
+            if (_ngram_window.size() == _ngram_length) {
+                _ngram_window.erase(_ngram_window.begin());
+            }
+
+            _ngram_window.push_back(name);
+
+            str_type gram = _ngram_window.back();
+
+            for (size_type i = _ngram_window.size() - 1; i-- > 0; ) {
+
+                gram = _ngram_window[i] + " " + gram;
+
+                _ngrams[gram] += 1;
+            }
         }
 
         inline void evaluator::define_enclosure(let& lam) {
@@ -139,8 +900,6 @@ namespace Olly {
             const lambda* l = lam.cast<lambda>();
 
             _variables.emplace_back(l->variables());
-
-            set_expression_on_return(op_call(OP_CODE::end_scope_op));
         }
 
         inline void evaluator::define_enclosure() {
@@ -148,6 +907,17 @@ namespace Olly {
         }
 
         inline void evaluator::delete_enclosure() {
+
+            if (_tracing_calls) {
+                trace_leave(_variables.size());
+            }
+
+#if OLIVER_PROFILE
+            if (_profiling) {
+                _profiler.leave(_variables.size());
+            }
+#endif
+
             if (!_variables.empty()) {
                 _variables.pop_back();
             }
@@ -162,13 +932,60 @@ namespace Olly {
             }
         }
 
+        inline bool_type evaluator::reuse_enclosure() {
+            /*
+                Collapse the enclosure of a tail call on to the
+                enclosure of its caller.  The caller has no work
+                left besides its own 'end_scope_op', so the callee's
+                variables are merged in to its scope rather than
+                nested, and the callee sees the same variables as
+                it would if nested.  Return false, leaving the scope
+                nested, when the caller's scope is the outermost.
+            */
+
+            if (_variables.size() <= 2) {
+                return false;
+            }
+
+            map_type& caller = _variables[_variables.size() - 2];
+
+            for (auto& var : _variables.back()) {
+                caller[var.first] = std::move(var.second);
+            }
+
+            _variables.pop_back();
+
+            return true;
+        }
+
+        inline bool_type evaluator::is_tail_call() const {
+            /*
+                A lambda is called in tail position when the only
+                code left pending in its caller is the caller's
+                own 'end_scope_op'.
+            */
+
+            return peek_expression_from_code().op_code() == OP_CODE::end_scope_op;
+        }
+
         inline void evaluator::set_expression_on_code(let exp) {
+            /*
+                Schedule an operation ahead of the remaining code
+                of the current frame.  The operation is held on the
+                '_pending' buffer, rather than being placed on to a
+                new cons cell of the frame's body.
+            */
+
+            if (exp.is_nothing()) {
+                return;
+            }
 
             if (_code.empty()) {
-                _code.emplace_back(expression());
+                _code.emplace_back(code_frame{ expression(), 0 });
             }
 
-            _code.back() = _code.back().place_lead(exp);
+            _pending.emplace_back(std::move(exp));
+            _code.back().pending += 1;
         }
 
         inline void evaluator::set_expression_on_stack(let exp) {
@@ -176,6 +993,7 @@ namespace Olly {
             if (_stack.size() < _max_stack_size) {
 
                 _stack.emplace_back(exp);
+                _stack_peak = std::max(_stack_peak, _stack.size());
                 return;
             }
 
@@ -187,6 +1005,7 @@ namespace Olly {
             if (_return.size() < _max_stack_size) {
 
                 _return.emplace_back(exp);
+                _return_peak = std::max(_return_peak, _return.size());
                 return;
             }
 
@@ -216,9 +1035,20 @@ namespace Olly {
 
                 let result = expression();
 
+                auto pending = _pending.cend();
+
                 for (auto i = _code.crbegin(); i != _code.crend(); ++i) {
 
-                    result = result.place_lead(*i);
+                    let frame = i->body;
+
+                    for (auto p = pending - i->pending; p != pending; ++p) {
+
+                        frame = frame.place_lead(*p);
+                    }
+
+                    pending -= i->pending;
+
+                    result = result.place_lead(frame);
                 }
 
                 return result;
@@ -228,8 +1058,20 @@ namespace Olly {
         }
 
         inline let evaluator::get_symbol(let& var) const {
+            /*
+                The name of a symbol is read in place, so a lookup
+                makes no string.
+            */
+
+            const symbol* s = var.cast<symbol>();
+
+            str_type other;
+
+            if (!s) {
+                other = str(var);
+            }
 
-            str_type symbol_name = str(var);
+            const str_type& symbol_name = s ? s->name() : other;
 
             for (auto i = _variables.crbegin(); i != _variables.crend(); ++i) {
 
@@ -249,7 +1091,15 @@ namespace Olly {
                 val = get_symbol(val);
             }
 
-            str_type symbol_name = repr(var);
+            const symbol* s = var.cast<symbol>();
+
+            str_type other;
+
+            if (!s) {
+                other = repr(var);
+            }
+
+            const str_type& symbol_name = s ? s->name() : other;
 
             if (_variables.empty()) {
                 _variables.emplace_back(map_type());
@@ -279,6 +1129,10 @@ namespace Olly {
             let val = _stack.back();
             _stack.pop_back();
 
+            if (_stack.size() < _stack_floor) {
+                _stack_floor = _stack.size();
+            }
+
             return val;
         }
 
@@ -288,21 +1142,87 @@ namespace Olly {
                 return error("Code underflow.");
             }
 
-            let a = pop_lead(_code.back());
+            code_frame& frame = _code.back();
 
-            if (expression_is_empty(_code.back())) {
+            if (frame.pending) {
+
+                let a = std::move(_pending.back());
+
+                _pending.pop_back();
+                frame.pending -= 1;
+
+                if (!frame.pending && expression_is_empty(frame.body)) {
+                    _code.pop_back();
+                }
+
+                return a;
+            }
+
+            let a = pop_lead(frame.body);
+
+            if (expression_is_empty(frame.body)) {
                 _code.pop_back();
             }
 
             return a;
         }
 
+        inline let evaluator::peek_expression_from_code() const {
+
+            if (_code.empty()) {
+                return error("Code underflow.");
+            }
+
+            const code_frame& frame = _code.back();
+
+            if (frame.pending) {
+                return _pending.back();
+            }
+
+            return frame.body.lead();
+        }
+
+        inline const let& evaluator::get_op_call(OP_CODE opr) {
+            /*
+                Return a shared instance of an operator, so that
+                scheduling an operation does not allocate a new
+                'op_call' each time it is placed on to the code.
+            */
+
+            static const stack_type op_calls = []() {
+
+                stack_type ops;
+
+                for (int_type i = 0; i < static_cast<int_type>(OP_CODE::END_OPERATORS_OP); ++i) {
+                    ops.emplace_back(op_call(static_cast<OP_CODE>(i)));
+                }
+
+                return ops;
+            }();
+
+            return op_calls[static_cast<size_type>(opr)];
+        }
+
         inline void evaluator::eval() {
 
             do {
 
+                if (--_countdown == 0 && suspend()) {
+                    return;
+                }
+
                 let exp = get_expression_from_code();  // Get an element from the code expression.
 
+                if (_ngram_length) {
+                    count_ngrams(exp);
+                }
+
+                str_type called;    // The symbol a lambda is called through, which names it in a profile or a trace.
+
+                if ((profiling() || _tracing_calls) && exp.type() == "symbol") {
+                    called = exp.cast<symbol>()->name();
+                }
+
                 while (exp.type() == "symbol") {  // Get the value of an abstraction.
                     exp = get_symbol(exp);
                 }
@@ -317,7 +1237,7 @@ namespace Olly {
                     exp = unwrap_expresion(exp);
 
                     if (!expression_is_empty(exp)) {
-                        _code.emplace_back(exp);
+                        _code.emplace_back(code_frame{ exp, 0 });
                     }
                 }
 
@@ -326,6 +1246,10 @@ namespace Olly {
                     let args = exp.lead();
                     let body = exp.last();
 
+                    bool_type memo = exp.cast<lambda>()->is_memoized();
+
+                    memo_cache::values_type memo_args;
+
                     define_enclosure(exp);
 
                     while (args.is()) {
@@ -333,12 +1257,100 @@ namespace Olly {
                         let var = pop_lead(args);
                         let val = get_expression_from_code();
 
+                        if (val.op_code() > OP_CODE::FUNCTION_OPERATORS && val.op_code() < OP_CODE::SUPER_OPERATORS) {
+
+                            unfuse(val);
+
+                            val = get_expression_from_code();
+                        }
+
                         if (var.type() == "symbol") {
                             set_symbol(var, val);
                         }
+
+                        if (memo) {
+                            memo_args.push_back(val);
+                        }
+                    }
+
+                    if (memo) {
+                        /*
+                            The body reads its free symbols from the
+                            caller's scope, so their values are keyed
+                            along with the arguments.  A symbol naming
+                            the lambda itself, as in a recursive call,
+                            is keyed as nothing.
+
+                            The body of a memoized lambda is pure, but
+                            the code it is given or reads by name may
+                            not be.  Such a call is not cached.
+                        */
+
+                        let free = exp.cast<lambda>()->free_symbols();
+
+                        while (free.is()) {
+
+                            let var = pop_lead(free);
+                            let val = get_symbol(var);
+
+                            memo_args.push_back(val.cast<lambda>() == exp.cast<lambda>() ? let(nothing()) : val);
+                        }
+
+                        for (size_type i = 0; memo && i < memo_args.size(); ++i) {
+                            memo = is_pure(memo_args[i]);
+                        }
+                    }
+
+                    if (memo) {
+                        /*
+                            A cached call places its result on to the
+                            stack in place of running the body.  Else
+                            the call is recorded once it has ended.
+                        */
+
+                        const memo_cache::values_type* result = _memo.find(exp, memo_args);
+
+                        if (result) {
+
+                            _variables.pop_back();
+
+                            for (const auto& val : *result) {
+                                set_expression_on_stack(val);
+                            }
+
+                            continue;
+                        }
+
+                        _memo_frames.emplace_back(memo_frame{ exp, std::move(memo_args), _stack.size(), _stack_floor });
+
+                        _stack_floor = _stack.size();
+
+                        set_expression_on_code(get_op_call(OP_CODE::memo_end_op));
+                        set_expression_on_return(get_op_call(OP_CODE::end_scope_op));
+                        set_expression_on_code(get_op_call(OP_CODE::end_scope_op));
+                    }
+
+                    else if (!is_tail_call() || !reuse_enclosure()) {
+                        set_expression_on_return(get_op_call(OP_CODE::end_scope_op));
+                        set_expression_on_code(get_op_call(OP_CODE::end_scope_op));
+                    }
+
+#if OLIVER_PROFILE
+                    if (_profiling) {
+                        _profiler.enter(exp, called, _variables.size());
+                    }
+#endif
+
+                    if (_tracing_calls) {
+                        trace_enter(called);
+                    }
+
+#if OLIVER_JIT
+                    if (!_ngram_length && !profiling() && run_compiled(body)) {
+                        continue;
                     }
+#endif
 
-                    set_expression_on_code(op_call(OP_CODE::end_scope_op));
                     set_expression_on_code(body);
                 }
 
@@ -346,35 +1358,315 @@ namespace Olly {
                     set_expression_on_stack(exp);
                 }
 
-                else {
+#if OLIVER_PROFILE
+                else if (_profiling) {
 
                     OP_CODE opr = exp.op_code();
 
-                    if (opr > OP_CODE::NOTHING_OP && opr < OP_CODE::END_OPERATORS_OP) {
+                    profiler::tick_type start = profiler::now();
 
-                        if (opr < OP_CODE::FUNDAMENTAL_OPERATORS) {
-                            fundamental_operators(opr);
-                        }
+                    dispatch(opr, exp);
 
-                        else if (opr < OP_CODE::SEQUENTIAL_OPERATORS) {
-                            sequence_operators(opr);
-                        }
+                    _profiler.count_op(opr, profiler::now() - start);
+                }
+#endif
 
-                        else if (opr < OP_CODE::ASSOCIATIVE_OPERATORS) {
-                            associative_operators(opr);
-                        }
+                else {
+                    dispatch(exp.op_code(), exp);
+                }
 
-                        else if (opr < OP_CODE::UNARY_OPERATORS) {
-                            unary_operators(opr);
-                        }
+            } while (!_code.empty());
+        }
 
-                        else if (opr < OP_CODE::BINARY_OPERATORS) {
-                            binary_operators(opr);
-                        }
-                    }
+        inline void evaluator::arm() {
+            /*
+                Start the allowance of each limit, and the count of
+                operators to the first check.
+            */
+
+            _yield = yield_type::none;
+
+            _ops_left   = _limits.operations ? _limits.operations : UNLIMITED;
+            _slice_left = (_async && _slice) ? _slice : UNLIMITED;
+
+            if (_limits.time.count()) {
+                _deadline = clock_type::now() + std::chrono::duration_cast<clock_type::duration>(_limits.time);
+            }
+
+            _alloc_base  = let::live_bytes();
+            _alloc_child = 0;
+            _ops_run     = 0;
+
+            _period    = next_period();
+            _countdown = _period + 1;   // The first check is made before the first operator.
+        }
+
+        inline size_type evaluator::next_period() const {
+
+            size_type period = std::min(_ops_left, _slice_left);
+
+            if (_limits.time.count() || _limits.allocation || _shared) {
+                period = std::min(period, CHECK_PERIOD);
+            }
+
+            return std::max<size_type>(period, 1);
+        }
+
+        inline size_type evaluator::operations_run() const {
+            /*
+                The operators run since 'arm'.  While running, the
+                operator being run is counted in the current period,
+                which a call stopped at a check has not begun.
+            */
+
+            if (_yield != yield_type::none) {
+                return _ops_run;
+            }
+
+            return _ops_run + _period + 1 - _countdown;
+        }
+
+        inline bool_type evaluator::suspend() {
+            /*
+                Called by the dispatch loop once the countdown runs
+                out, with '_period' operators run since the last
+                check.  Return true to stop before the next operator.
+                Else the count to the next check is started, with
+                the operator about to run as its first.
+            */
+
+            _ops_run += _period;
+
+            if (_shared) {
+                /*
+                    Draw the operators run from the allowance shared
+                    with the sibling evaluators.
+                */
+
+                size_type left = _shared->operations;
+
+                while (left != UNLIMITED && !_shared->operations.compare_exchange_weak(left, left - std::min(_period, left))) {
                 }
 
-            } while (!_code.empty());
+                _ops_left = (left == UNLIMITED) ? UNLIMITED : left - std::min(_period, left);
+            }
+            else if (_ops_left != UNLIMITED) {
+                _ops_left -= std::min(_period, _ops_left);
+            }
+
+            if (_slice_left != UNLIMITED) {
+                _slice_left -= std::min(_period, _slice_left);
+            }
+
+            if (_limits.operations && !_ops_left) {
+                _yield = yield_type::operations;
+                return true;
+            }
+
+            if (_limits.time.count() && clock_type::now() >= _deadline) {
+                _yield = yield_type::deadline;
+                return true;
+            }
+
+            if (_limits.allocation && allocated() > static_cast<std::int64_t>(_limits.allocation)) {
+                _yield = yield_type::memory;
+                return true;
+            }
+
+            if (_shared && _shared->yield != yield_type::none) {
+                _yield = _shared->yield;    // A sibling has been preempted.
+                return true;
+            }
+
+            if (preempted()) {
+                return true;    // A child evaluator has been preempted.
+            }
+
+            if (_yield == yield_type::output) {
+                return true;
+            }
+
+            if (_async && _slice && !_slice_left) {
+                _yield = yield_type::budget;
+                return true;
+            }
+
+            _period    = next_period();
+            _countdown = _period;
+
+            return false;
+        }
+
+        inline void evaluator::yield_on_output() {
+            /*
+                Check at the next boundary, counting the operators
+                run so far in this period.
+            */
+
+            if (_async) {
+
+                _period    = _period + 1 - _countdown;
+                _countdown = 1;
+
+                _yield = yield_type::output;
+            }
+        }
+
+        inline let evaluator::finish() const {
+            /*
+                A preempted evaluation returns an error naming the
+                limit, and keeps its state for 'resume'.
+            */
+
+            switch (_yield) {
+
+            case yield_type::operations:
+                return error("Preempted: operation limit.");
+
+            case yield_type::deadline:
+                return error("Preempted: time limit.");
+
+            case yield_type::memory:
+                return error("Preempted: allocation limit.");
+
+            default:
+                break;
+            }
+
+            return get_result_stack();
+        }
+
+        inline void evaluator::take_output(evaluator& child) {
+            /*
+                A child of an evaluator whose output is buffered
+                buffers its own, which is added to its parent's
+                once it has run.
+            */
+
+            _output += child._output;
+
+            child._output.clear();
+        }
+
+        inline bool_type evaluator::limited() const {
+            return _limits.operations || _limits.time.count() || _limits.allocation;
+        }
+
+        inline size_type evaluator::remaining_operations() const {
+            /*
+                The operators left to run, less those run since the
+                last check, to be shared by the evaluators which a
+                collection operator runs.
+            */
+
+            if (!_limits.operations || _shared) {
+                return _shared ? size_type(_shared->operations) : UNLIMITED;
+            }
+
+            return _ops_left - std::min(_ops_left, _period + 1 - _countdown);
+        }
+
+        inline std::int64_t evaluator::allocated() {
+            /*
+                The bytes allocated since 'arm'.  An evaluator run
+                by a collection operator adds what it has allocated
+                on its own thread to its allowance, and returns the
+                bytes allocated by its parent and its siblings too.
+            */
+
+            std::int64_t bytes = let::live_bytes() - _alloc_base;
+
+            if (_shared) {
+
+                _shared->bytes += bytes - _alloc_told;
+                _alloc_told     = bytes;
+
+                return _shared->used + _shared->bytes;
+            }
+
+            return bytes + _alloc_child;
+        }
+
+        inline bool_type evaluator::settle(const allowance& own) {
+            /*
+                Called once the evaluators run by a collection
+                operator have ended.  The operators they ran are
+                charged to this evaluator, and a check is made
+                before its next operator.  Return true if one was
+                preempted, and so this evaluator is too.
+
+                The bytes they allocated are charged too.  Those
+                allocated on this thread are taken out of its own
+                count, so they are not counted twice.
+            */
+
+            if (!limited()) {
+                return false;
+            }
+
+            const allowance& shared = _shared ? *_shared : own;
+
+            if (!_shared && own.granted != UNLIMITED) {
+                _ops_left -= std::min(_ops_left, own.granted - own.operations);
+            }
+
+            if (!_shared) {
+                _alloc_child += own.bytes;
+                _alloc_base  += let::live_bytes() - own.base;
+            }
+
+            _period    = _period + 1 - _countdown;
+            _countdown = 1;
+
+            if (shared.yield == yield_type::none) {
+                return false;
+            }
+
+            _yield = shared.yield;
+
+            return true;
+        }
+
+        inline void evaluator::dispatch(OP_CODE opr, const let& site) {
+
+#if OLIVER_LET_STATS
+            let_stats::op_scope counted(opr);   // Count the objects the operator makes against it.
+#endif
+
+            if (opr > OP_CODE::NOTHING_OP && opr < OP_CODE::END_OPERATORS_OP) {
+
+                if (opr < OP_CODE::FUNDAMENTAL_OPERATORS) {
+                    fundamental_operators(opr);
+                }
+
+                else if (opr < OP_CODE::SEQUENTIAL_OPERATORS) {
+                    sequence_operators(opr, site);
+                }
+
+                else if (opr < OP_CODE::ASSOCIATIVE_OPERATORS) {
+                    associative_operators(opr);
+                }
+
+                else if (opr < OP_CODE::UNARY_OPERATORS) {
+                    unary_operators(opr);
+                }
+
+                else if (opr < OP_CODE::BINARY_OPERATORS) {
+                    binary_operators(opr, site);
+                }
+
+                else if (opr < OP_CODE::FUNCTION_OPERATORS) {
+                    function_operators(opr);
+                }
+
+                else if (opr < OP_CODE::SUPER_OPERATORS) {
+                    super_operators(opr, site);
+                }
+
+                else if (opr < OP_CODE::COLLECTION_OPERATORS) {
+                    collection_operators(opr);
+                }
+            }
         }
     }  // end eval
 } // end Olly
@@ -383,4 +1675,8 @@ namespace Olly {
 #include    "sequence_operators.h"
 #include "associative_operators.h"
 #include       "unary_operators.h"
-#include      "binary_operators.h"
\ No newline at end of file
+#include      "binary_operators.h"
+#include    "function_operators.h"
+#include       "super_operators.h"
+#include  "collection_operators.h"
+#include         "jit_templates.h"
\ No newline at end of file
@@ -0,0 +1,274 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <semaphore>
+#include <thread>
+
+#include "../parser.h"
+#include "../Compiler/optimizer.h"
+#include "evaluator.h"
+
+namespace Olly {
+    namespace eval {
+
+        /********************************************************************************************/
+        //
+        //                              'evaluator_pool' class definition
+        //
+        //        The evaluator_pool class runs many independent programs at once.  It
+        //        holds one evaluator on each of its worker threads, kept for the life
+        //        of the pool, so the code each has compiled for hot lambdas and the
+        //        results it has memoized are kept from one program to the next.
+        //
+        //        Programs are compiled once with 'compile' and may be submitted any
+        //        number of times.  Compiled code is immutable, so every worker runs
+        //        the same code and shares the constants within it.  'submit' places
+        //        a program on a bounded lock-free queue and returns a future of the
+        //        stack the program leaves.
+        //
+        /********************************************************************************************/
+
+        class evaluator_pool {
+
+            struct job {
+                let                 code;
+                std::promise<let>   result;
+            };
+
+            struct cell {
+                /*
+                    A slot of the queue.  Its sequence number tells
+                    whether it is free for the producer of a given
+                    position, or holds the job for its consumer.
+                */
+                std::atomic<size_type>  sequence;
+                job*                    data;
+            };
+
+            std::unique_ptr<cell[]>         _cells;
+            size_type                       _mask;
+            std::atomic<size_type>          _head;      // The next position to be written.
+            std::atomic<size_type>          _tail;      // The next position to be read.
+            std::counting_semaphore<>       _ready;     // Counts the jobs on the queue.
+            std::atomic<bool_type>          _stop;
+            std::vector<std::thread>        _workers;
+
+        public:
+
+            static const size_type DEFAULT_CAPACITY;
+
+            evaluator_pool(size_type threads);
+            evaluator_pool(size_type threads, size_type capacity);
+            virtual ~evaluator_pool();
+
+            std::future<let> submit(let code);
+
+            size_type size() const;
+
+            static let compile(const str_type& text);
+
+        private:
+
+            evaluator_pool(const evaluator_pool& obj) = delete;
+
+            bool_type push(job* j);
+            job* pop();
+
+            void run();
+        };
+
+
+
+        const size_type evaluator_pool::DEFAULT_CAPACITY = 1024;
+
+        evaluator_pool::evaluator_pool(size_type threads) : evaluator_pool(threads, DEFAULT_CAPACITY) {
+        }
+
+        evaluator_pool::evaluator_pool(size_type threads, size_type capacity) :
+            _cells(), _mask(0), _head(0), _tail(0), _ready(0), _stop(false), _workers() {
+
+            size_type size = 2;
+
+            while (size < capacity) {
+                size <<= 1;
+            }
+
+            _cells = std::make_unique<cell[]>(size);
+            _mask  = size - 1;
+
+            for (size_type i = 0; i < size; ++i) {
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+                _cells[i].data = nullptr;
+            }
+
+            for (size_type i = 0; i < std::max<size_type>(threads, 1); ++i) {
+                _workers.emplace_back(&evaluator_pool::run, this);
+            }
+        }
+
+        evaluator_pool::~evaluator_pool() {
+            /*
+                Finish the jobs already submitted before stopping.
+            */
+
+            _stop.store(true);
+
+            _ready.release(static_cast<std::ptrdiff_t>(_workers.size()));
+
+            for (auto& worker : _workers) {
+                worker.join();
+            }
+        }
+
+        inline std::future<let> evaluator_pool::submit(let code) {
+
+            job* j = new job{ code, std::promise<let>() };
+
+            std::future<let> result = j->result.get_future();
+
+            while (!push(j)) {
+                std::this_thread::yield();      // The queue is full.
+            }
+
+            _ready.release();
+
+            return result;
+        }
+
+        inline size_type evaluator_pool::size() const {
+            return _workers.size();
+        }
+
+        inline let evaluator_pool::compile(const str_type& text) {
+
+            parser lex(text);
+
+            compiler comp(lex.parse());
+
+            optimizer opt;
+
+            return opt.optimize(comp.compile());
+        }
+
+        inline bool_type evaluator_pool::push(job* j) {
+
+            size_type pos = _head.load(std::memory_order_relaxed);
+
+            while (true) {
+
+                cell& c = _cells[pos & _mask];
+
+                size_type seq = c.sequence.load(std::memory_order_acquire);
+
+                if (seq == pos) {
+
+                    if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+
+                        c.data = j;
+                        c.sequence.store(pos + 1, std::memory_order_release);
+
+                        return true;
+                    }
+                }
+                else if (seq < pos) {
+                    return false;
+                }
+                else {
+                    pos = _head.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        inline evaluator_pool::job* evaluator_pool::pop() {
+
+            size_type pos = _tail.load(std::memory_order_relaxed);
+
+            while (true) {
+
+                cell& c = _cells[pos & _mask];
+
+                size_type seq = c.sequence.load(std::memory_order_acquire);
+
+                if (seq == pos + 1) {
+
+                    if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+
+                        job* j = c.data;
+
+                        c.sequence.store(pos + _mask + 1, std::memory_order_release);
+
+                        return j;
+                    }
+                }
+                else if (seq < pos + 1) {
+                    return nullptr;
+                }
+                else {
+                    pos = _tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        inline void evaluator_pool::run() {
+
+            evaluator olly;
+
+            while (true) {
+
+                _ready.acquire();
+
+                job* j = pop();
+
+                while (!j && !_stop.load()) {
+                    /*
+                        A job is counted for each release, so one is
+                        on the queue unless the pool is stopping.
+                    */
+
+                    std::this_thread::yield();
+
+                    j = pop();
+                }
+
+                if (!j) {
+                    return;
+                }
+
+                try {
+                    j->result.set_value(olly.eval(j->code));
+                }
+                catch (...) {
+                    j->result.set_exception(std::current_exception());
+                }
+
+                olly.reset();
+
+                delete j;
+            }
+        }
+
+    }  // end eval
+} // end Olly
@@ -34,6 +34,27 @@ namespace Olly {
                 delete_enclosure();
             }	break;
 
+            case OP_CODE::memo_end_op: {   // Cache the result of a memoized call.
+
+                if (_memo_frames.empty()) {
+                    break;
+                }
+
+                memo_frame frame = std::move(_memo_frames.back());
+                _memo_frames.pop_back();
+
+                if (_stack_floor >= frame.height && _stack.size() >= frame.height) {
+
+                    stack_type result(_stack.begin() + frame.height, _stack.end());
+
+                    _memo.store(frame.lam, std::move(frame.args), std::move(result));
+                }
+
+                if (frame.floor < _stack_floor) {
+                    _stack_floor = frame.floor;
+                }
+            }	break;
+
 
 
 
@@ -70,12 +91,12 @@ namespace Olly {
                             set_expression_on_code(val.last());
                             set_expression_on_code(val.lead());
                             set_expression_on_code(var);
-                            set_expression_on_code(op_call(OP_CODE::def_op));
+                            set_expression_on_code(get_op_call(OP_CODE::def_op));
                         }
 
                         else {
                             set_expression_on_code(var);
-                            set_expression_on_code(op_call(OP_CODE::LET_op));
+                            set_expression_on_code(get_op_call(OP_CODE::LET_op));
                             set_expression_on_code(val);
                         }
                     }
@@ -122,7 +143,7 @@ namespace Olly {
 
                     // We can reuse the apply_op as all other instances
                     // of the operator were compiled out of the code.
-                    let oper = op_call(OP_CODE::apply_op);
+                    let oper = get_op_call(OP_CODE::apply_op);
 
                     set_expression_on_code(vars);
                     set_expression_on_code(oper);
@@ -140,10 +161,10 @@ namespace Olly {
                 let vals = get_expression_from_stack();
                 let vars = get_expression_from_code();
 
-                set_expression_on_code(op_call(OP_CODE::EQ_op));
+                set_expression_on_code(get_op_call(OP_CODE::EQ_op));
                 set_expression_on_code(vals);
                 set_expression_on_code(vars);
-                set_expression_on_code(op_call(OP_CODE::let_op));
+                set_expression_on_code(get_op_call(OP_CODE::let_op));
             } break;
 
 
@@ -175,7 +196,7 @@ namespace Olly {
 
                 set_expression_on_stack(lam);
                 set_expression_on_code(var);
-                set_expression_on_code(op_call(OP_CODE::LET_op));
+                set_expression_on_code(get_op_call(OP_CODE::LET_op));
             }	break;
 
 
@@ -186,7 +207,7 @@ namespace Olly {
                 let queue = get_result_queue();
 
                 set_expression_on_code(queue.reverse());
-                set_expression_on_code(op_call(OP_CODE::end_scope_op));
+                set_expression_on_code(get_op_call(OP_CODE::end_scope_op));
             }   break;
 
 
@@ -218,7 +239,7 @@ namespace Olly {
                 queue = queue.place_lead(a);
             }
 
-            let end = op_call(OP_CODE::end_scope_op);
+            let end = get_op_call(OP_CODE::end_scope_op);
             let itr = get_expression_from_code();
 
             while (end != itr) {
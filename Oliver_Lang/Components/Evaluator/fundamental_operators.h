@@ -46,8 +46,8 @@ namespace Olly {
                     set_symbol(var, val);
                 }
                 else {
-                    set_expression_on_code(op_call(OP_CODE::ENDL_op));
-                    set_expression_on_code(op_call(OP_CODE::EMIT_op));
+                    set_expression_on_code(get_op_call(OP_CODE::ENDL_op));
+                    set_expression_on_code(get_op_call(OP_CODE::EMIT_op));
                     set_expression_on_code(error("Miss handled assignment!"));
                 }
             }	break;
@@ -59,6 +59,11 @@ namespace Olly {
                 set_expression_on_stack(stack);
             }	break;
 
+            case OP_CODE::STATS_op: {   // Place the counts of the objects made by each data type on to the stack.
+
+                set_expression_on_stack(get_let_stats());
+            }	break;
+
             case OP_CODE::QUEUE_op: {   // Print a string representation of the queue.
 
                 let queue = get_eval_queue();
@@ -78,11 +83,15 @@ namespace Olly {
 
                     _stack.clear();
 
+                    _stack_floor = 0;
+
                 }	break;
 
                 case OP_CODE::QUEUE_op: {   // Clear the the remainder of code to execute.
 
                     _code.clear();
+                    _pending.clear();
+                    _memo_frames.clear();
 
                 }	break;
 
@@ -101,13 +110,17 @@ namespace Olly {
 
                 let val = get_expression_from_stack();
 
-                std::cout << str(val);
+                emit(val);
+
+                yield_on_output();
 
             }   break;
 
             case OP_CODE::ENDL_op: {
 
-                std::cout << std::endl;
+                emit_line();
+
+                yield_on_output();
 
             }   break;
 
@@ -143,12 +156,12 @@ namespace Olly {
                         set_expression_on_stack(var);
 
                         if (oper.op_code() == OP_CODE::BIND_op) {
-                            set_expression_on_code(op_call(OP_CODE::LET_op));
+                            set_expression_on_code(get_op_call(OP_CODE::LET_op));
                             set_expression_on_code(val);
                         }
                         else {
                             set_expression_on_stack(val);
-                            set_expression_on_code(op_call(OP_CODE::LET_op));
+                            set_expression_on_code(get_op_call(OP_CODE::LET_op));
                         }
                     }
                 }
@@ -194,5 +207,38 @@ namespace Olly {
             }
         }
 
+        inline let evaluator::get_let_stats() {
+            /*
+                A list holding a list for each data type of its
+                name, and the objects made, released and copied
+                and the bytes they hold.
+
+                    [ [ "number" 12 10 64 40 ] ... ]
+            */
+
+#if OLIVER_LET_STATS
+            auto counts = let_stats::types();
+
+            let result = list();
+
+            for (auto i = counts.crbegin(); i != counts.crend(); ++i) {
+
+                let entry = list();
+
+                entry = entry.place_lead(number(static_cast<real_type>(i->copies)));
+                entry = entry.place_lead(number(static_cast<real_type>(i->live_bytes)));
+                entry = entry.place_lead(number(static_cast<real_type>(i->frees)));
+                entry = entry.place_lead(number(static_cast<real_type>(i->allocations)));
+                entry = entry.place_lead(string(i->name));
+
+                result = result.place_lead(entry);
+            }
+
+            return result;
+#else
+            return error("STATS needs a build with OLIVER_LET_STATS.");
+#endif
+        }
+
     }  // end eval
-} // end Olly
\ No newline at end of file
+} // end Olly
@@ -0,0 +1,449 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include <iomanip>
+#include <map>
+#include <unordered_map>
+
+#include "../Compiler/compiler.h"
+
+namespace Olly {
+    namespace eval {
+
+        /********************************************************************************************/
+        //
+        //                                'heap_snapshot' class definition
+        //
+        //        The heap_snapshot class is the graph of the objects reachable from a
+        //        set of named roots.  Objects are shared between 'let's, so each object
+        //        is a node of the graph once, however many 'let's hold it.
+        //
+        //        An object's retained size is the bytes which would be released with
+        //        it: its own block, and the blocks of every object reached only through
+        //        it.  These are found from the dominator tree of the graph, rooted at a
+        //        node above the named roots.  A node's size is the block counted by
+        //        'let::live_bytes', and not any memory the object holds elsewhere.
+        //
+        //        The snapshot is written by 'dump' as lines of text:
+        //
+        //            oliver-heap 1
+        //            node <id> <type> <bytes> <retained> <dominator>
+        //            edge <from> <to>
+        //            root <id> <label>
+        //
+        //        Node 0 is the node above the roots, of type 'roots'.  Every other
+        //        node's dominator is a node listed before it.
+        //
+        /********************************************************************************************/
+
+        class heap_snapshot {
+        public:
+
+            struct type_entry {
+                str_type                name;
+                size_type               count;
+                size_type               bytes;      // The blocks of the type's objects.
+                size_type               retained;   // The bytes retained by the type's objects, counting each byte once.
+                std::vector<size_type>  top;        // The nodes retaining the most, most first.
+            };
+
+        private:
+
+            struct node {
+                let                     value;
+                str_type                type;
+                size_type               bytes;
+                size_type               root;       // The root first reached through.
+                std::vector<size_type>  edges;
+                size_type               order;      // Position in reverse post order.
+                size_type               dominator;
+                size_type               retained;
+            };
+
+            std::vector<node>                           _nodes;
+            std::vector<str_type>                       _roots;     // The label of each root.
+            std::vector<size_type>                      _root_ids;
+            std::unordered_map<const void*, size_type>  _ids;
+            bool_type                                   _built;
+
+        public:
+
+            static const size_type TOP;
+
+            heap_snapshot();
+            virtual ~heap_snapshot();
+
+            void add_root(const str_type& label, const let& value);
+
+            size_type nodes() const;
+
+            std::vector<type_entry> types();
+            str_type report(size_type top);
+            str_type dump();
+
+        private:
+
+            heap_snapshot(const heap_snapshot& obj) = delete;
+
+            size_type visit(const let& value, size_type root);
+            void build();
+            size_type intersect(size_type a, size_type b) const;
+        };
+
+
+
+        const size_type heap_snapshot::TOP = 3;     // The retainers kept for each type.
+
+        heap_snapshot::heap_snapshot() : _nodes(), _roots(), _root_ids(), _ids(), _built(false) {
+            _nodes.push_back(node{ let(), "roots", 0, 0, {}, 0, 0, 0 });
+        }
+
+        heap_snapshot::~heap_snapshot() {
+        }
+
+        inline size_type heap_snapshot::visit(const let& value, size_type root) {
+            /*
+                Return the id of an object's node, adding a new node
+                for an object not seen before.
+            */
+
+            auto found = _ids.find(value.address());
+
+            if (found != _ids.end()) {
+                return found->second;
+            }
+
+            size_type id = _nodes.size();
+
+            _ids.emplace(value.address(), id);
+            _nodes.push_back(node{ value, value.type(), value.bytes(), root, {}, 0, 0, 0 });
+
+            return id;
+        }
+
+        inline void heap_snapshot::add_root(const str_type& label, const let& value) {
+            /*
+                Walk the objects reachable from a root, depth first
+                with a stack of its own, so that a long expression
+                does not run out of call stack.
+            */
+
+            size_type root = _roots.size();
+
+            _roots.push_back(label);
+
+            size_type seen = _nodes.size();
+            size_type id   = visit(value, root);
+
+            _root_ids.push_back(id);
+            _nodes[0].edges.push_back(id);
+
+            _built = false;
+
+            if (id < seen) {
+                return;
+            }
+
+            std::vector<size_type> work{ id };
+            std::vector<let>       children;
+
+            while (!work.empty()) {
+
+                size_type n = work.back();
+                work.pop_back();
+
+                children.clear();
+                _nodes[n].value.children(children);
+
+                for (const let& c : children) {
+
+                    size_type before = _nodes.size();
+                    size_type child  = visit(c, root);
+
+                    _nodes[n].edges.push_back(child);
+
+                    if (child >= before) {
+                        work.push_back(child);
+                    }
+                }
+            }
+        }
+
+        inline size_type heap_snapshot::nodes() const {
+            return _nodes.size() - 1;
+        }
+
+        inline size_type heap_snapshot::intersect(size_type a, size_type b) const {
+
+            while (a != b) {
+
+                while (_nodes[a].order > _nodes[b].order) {
+                    a = _nodes[a].dominator;
+                }
+
+                while (_nodes[b].order > _nodes[a].order) {
+                    b = _nodes[b].dominator;
+                }
+            }
+
+            return a;
+        }
+
+        inline void heap_snapshot::build() {
+            /*
+                Find each node's immediate dominator by the method of
+                Cooper, Harvey and Kennedy, over the nodes in reverse
+                post order, then sum the retained sizes up the tree.
+            */
+
+            if (_built) {
+                return;
+            }
+
+            size_type n = _nodes.size();
+
+            std::vector<size_type> post;
+            std::vector<bool_type> seen(n, false);
+            std::vector<std::pair<size_type, size_type>> work{ { 0, 0 } };
+
+            seen[0] = true;
+
+            while (!work.empty()) {
+
+                auto& [v, next] = work.back();
+
+                if (next < _nodes[v].edges.size()) {
+
+                    size_type w = _nodes[v].edges[next++];
+
+                    if (!seen[w]) {
+                        seen[w] = true;
+                        work.push_back({ w, 0 });
+                    }
+                }
+                else {
+                    post.push_back(v);
+                    work.pop_back();
+                }
+            }
+
+            std::vector<std::vector<size_type>> preds(n);
+
+            for (size_type v = 0; v < n; ++v) {
+
+                for (size_type w : _nodes[v].edges) {
+                    preds[w].push_back(v);
+                }
+            }
+
+            const size_type UNSET = std::numeric_limits<size_type>::max();
+
+            for (size_type i = 0; i < post.size(); ++i) {
+                _nodes[post[i]].order     = post.size() - 1 - i;
+                _nodes[post[i]].dominator = UNSET;
+            }
+
+            _nodes[0].dominator = 0;
+
+            for (bool_type changed = true; changed;) {
+
+                changed = false;
+
+                for (auto v = post.rbegin() + 1; v != post.rend(); ++v) {
+
+                    size_type dom = UNSET;
+
+                    for (size_type p : preds[*v]) {
+
+                        if (_nodes[p].dominator != UNSET) {
+                            dom = (dom == UNSET) ? p : intersect(p, dom);
+                        }
+                    }
+
+                    if (_nodes[*v].dominator != dom) {
+                        _nodes[*v].dominator = dom;
+                        changed = true;
+                    }
+                }
+            }
+
+            for (auto& v : _nodes) {
+                v.retained = v.bytes;
+            }
+
+            for (size_type v : post) {
+
+                if (v) {
+                    _nodes[_nodes[v].dominator].retained += _nodes[v].retained;
+                }
+            }
+
+            _built = true;
+        }
+
+        inline std::vector<heap_snapshot::type_entry> heap_snapshot::types() {
+            /*
+                The objects of each type, most retained first.  An
+                object within another of its type, such as the tail
+                of an expression, adds to the type's count and bytes
+                but its retained bytes are already counted, and it
+                is not listed as a retainer.
+            */
+
+            build();
+
+            std::map<str_type, type_entry> types;
+
+            std::vector<std::pair<size_type, size_type>> work;
+            std::vector<std::vector<size_type>> tree(_nodes.size());
+            std::map<str_type, size_type> open;     // The nodes of each type above the node being visited.
+
+            for (size_type v = 1; v < _nodes.size(); ++v) {
+                tree[_nodes[v].dominator].push_back(v);
+            }
+
+            work.push_back({ 0, 0 });
+
+            while (!work.empty()) {
+
+                auto& [v, next] = work.back();
+
+                if (next == 0 && v) {
+
+                    const node& x = _nodes[v];
+
+                    type_entry& t = types.try_emplace(x.type, type_entry{ x.type, 0, 0, 0, {} }).first->second;
+
+                    t.count += 1;
+                    t.bytes += x.bytes;
+
+                    if (!open[x.type]) {
+
+                        t.retained += x.retained;
+
+                        t.top.push_back(v);
+
+                        std::sort(t.top.begin(), t.top.end(), [this](size_type a, size_type b) { return _nodes[a].retained > _nodes[b].retained; });
+
+                        if (t.top.size() > TOP) {
+                            t.top.pop_back();
+                        }
+                    }
+
+                    open[x.type] += 1;
+                }
+
+                if (next < tree[v].size()) {
+                    size_type w = tree[v][next++];
+                    work.push_back({ w, 0 });
+                }
+                else {
+
+                    if (v) {
+                        open[_nodes[v].type] -= 1;
+                    }
+
+                    work.pop_back();
+                }
+            }
+
+            std::vector<type_entry> result;
+
+            for (auto& t : types) {
+                result.push_back(std::move(t.second));
+            }
+
+            std::sort(result.begin(), result.end(), [](const type_entry& a, const type_entry& b) { return a.retained > b.retained; });
+
+            return result;
+        }
+
+        inline str_type heap_snapshot::report(size_type top) {
+
+            std::vector<type_entry> entries = types();
+
+            stream_type out;
+
+            out << nodes() << " objects reachable from " << _roots.size() << " roots, retaining " << _nodes[0].retained << " bytes" << std::endl;
+
+            out << std::left << std::setw(16) << "type" << std::right << std::setw(10) << "count" << std::setw(12) << "bytes" << std::setw(12) << "retained" << std::endl;
+
+            for (size_type i = 0; i < entries.size() && i < top; ++i) {
+
+                const type_entry& t = entries[i];
+
+                out << std::left << std::setw(16) << t.name << std::right << std::setw(10) << t.count << std::setw(12) << t.bytes << std::setw(12) << t.retained << std::endl;
+
+                for (size_type v : t.top) {
+
+                    str_type text = repr(_nodes[v].value);
+
+                    if (text.size() > 40) {
+                        text = text.substr(0, 37) + "...";
+                    }
+
+                    out << std::setw(38) << _nodes[v].retained << "  " << _roots[_nodes[v].root] << "  " << text << std::endl;
+                }
+            }
+
+            return out.str();
+        }
+
+        inline str_type heap_snapshot::dump() {
+            /*
+                Nodes are written in reverse post order, so that each
+                node's dominator comes before it.
+            */
+
+            build();
+
+            std::vector<size_type> order(_nodes.size());
+
+            for (size_type v = 0; v < _nodes.size(); ++v) {
+                order[_nodes[v].order] = v;
+            }
+
+            stream_type out;
+
+            out << "oliver-heap 1" << std::endl;
+
+            for (size_type v : order) {
+                out << "node " << v << " " << _nodes[v].type << " " << _nodes[v].bytes << " " << _nodes[v].retained << " " << _nodes[v].dominator << std::endl;
+            }
+
+            for (size_type v = 0; v < _nodes.size(); ++v) {
+
+                for (size_type w : _nodes[v].edges) {
+                    out << "edge " << v << " " << w << std::endl;
+                }
+            }
+
+            for (size_type i = 0; i < _roots.size(); ++i) {
+                out << "root " << _root_ids[i] << " " << _roots[i] << std::endl;
+            }
+
+            return out.str();
+        }
+
+    }  // end eval
+} // end Olly
@@ -0,0 +1,222 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+
+#include "../Compiler/compiler.h"
+
+namespace Olly {
+    namespace eval {
+
+        /********************************************************************************************/
+        //
+        //                                'histogram' class definition
+        //
+        //        The histogram class counts values in buckets of a fixed relative width,
+        //        after the HDR histogram.  Each power of two is split into SUB_BUCKETS
+        //        buckets, so a value is known to within about 1 part in SUB_BUCKETS over
+        //        the whole range of 64 bit values.  Recording a value is a few shifts
+        //        and an increment, and never allocates.
+        //
+        /********************************************************************************************/
+
+        class histogram {
+        public:
+
+            typedef     std::uint64_t   value_type;
+
+            static constexpr size_type SUB_BITS    = 4;
+            static constexpr size_type SUB_BUCKETS = size_type(1) << SUB_BITS;
+            static constexpr size_type BUCKETS     = (64 - SUB_BITS + 1) << SUB_BITS;
+
+        private:
+
+            std::array<value_type, BUCKETS> _counts;
+            value_type                      _count;
+            value_type                      _total;
+            value_type                      _min;
+            value_type                      _max;
+
+        public:
+
+            histogram();
+            virtual ~histogram();
+
+            void record(value_type value);
+            void merge(const histogram& other);
+            void clear();
+
+            value_type count() const;
+            value_type min() const;
+            value_type max() const;
+            real_type  mean() const;
+            value_type percentile(real_type p) const;
+
+            str_type report(const str_type& unit) const;
+
+            static size_type  bucket(value_type value);
+            static value_type highest(size_type index);
+        };
+
+
+
+        histogram::histogram() : _counts(), _count(0), _total(0), _min(std::numeric_limits<value_type>::max()), _max(0) {
+        }
+
+        histogram::~histogram() {
+        }
+
+        inline size_type histogram::bucket(value_type value) {
+            /*
+                Values below SUB_BUCKETS have a bucket each.  Above,
+                a value's bucket is found from its highest bit and
+                the SUB_BITS bits below it.
+            */
+
+            if (value < SUB_BUCKETS) {
+                return static_cast<size_type>(value);
+            }
+
+            size_type exponent = static_cast<size_type>(std::bit_width(value)) - 1;
+            size_type sub      = static_cast<size_type>(value >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+
+            return ((exponent - SUB_BITS + 1) << SUB_BITS) + sub;
+        }
+
+        inline histogram::value_type histogram::highest(size_type index) {
+            /*
+                The highest value counted in a bucket.
+            */
+
+            if (index < SUB_BUCKETS) {
+                return index;
+            }
+
+            size_type exponent = (index >> SUB_BITS) + SUB_BITS - 1;
+            size_type sub      = index & (SUB_BUCKETS - 1);
+
+            value_type low = static_cast<value_type>(SUB_BUCKETS + sub) << (exponent - SUB_BITS);
+
+            return low + (value_type(1) << (exponent - SUB_BITS)) - 1;
+        }
+
+        inline void histogram::record(value_type value) {
+
+            _counts[bucket(value)] += 1;
+
+            _count += 1;
+            _total += value;
+
+            _min = std::min(_min, value);
+            _max = std::max(_max, value);
+        }
+
+        inline void histogram::merge(const histogram& other) {
+
+            for (size_type i = 0; i < BUCKETS; ++i) {
+                _counts[i] += other._counts[i];
+            }
+
+            _count += other._count;
+            _total += other._total;
+
+            _min = std::min(_min, other._min);
+            _max = std::max(_max, other._max);
+        }
+
+        inline void histogram::clear() {
+
+            _counts.fill(0);
+
+            _count = 0;
+            _total = 0;
+            _min   = std::numeric_limits<value_type>::max();
+            _max   = 0;
+        }
+
+        inline histogram::value_type histogram::count() const {
+            return _count;
+        }
+
+        inline histogram::value_type histogram::min() const {
+            return _count ? _min : 0;
+        }
+
+        inline histogram::value_type histogram::max() const {
+            return _max;
+        }
+
+        inline real_type histogram::mean() const {
+            return _count ? static_cast<real_type>(_total) / _count : 0;
+        }
+
+        inline histogram::value_type histogram::percentile(real_type p) const {
+            /*
+                The highest value of the bucket holding the value
+                below which 'p' percent of the values lie.
+            */
+
+            if (!_count) {
+                return 0;
+            }
+
+            value_type rank = static_cast<value_type>(p / 100 * _count + 0.5);
+
+            rank = std::max<value_type>(rank, 1);
+
+            value_type seen = 0;
+
+            for (size_type i = 0; i < BUCKETS; ++i) {
+
+                seen += _counts[i];
+
+                if (seen >= rank) {
+                    return std::min(highest(i), _max);
+                }
+            }
+
+            return _max;
+        }
+
+        inline str_type histogram::report(const str_type& unit) const {
+
+            stream_type out;
+
+            out << "count " << count()
+                << "  min " << min() << unit
+                << "  p50 " << percentile(50) << unit
+                << "  p90 " << percentile(90) << unit
+                << "  p99 " << percentile(99) << unit
+                << "  p99.9 " << percentile(99.9) << unit
+                << "  max " << max() << unit
+                << "  mean " << std::fixed << std::setprecision(1) << static_cast<double>(mean()) << unit;
+
+            return out.str();
+        }
+
+    }  // end eval
+} // end Olly
@@ -0,0 +1,344 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+/*
+    The JIT is built by default on x86-64 Linux and macOS.  Define
+    OLIVER_JIT as 0 to build without it.
+*/
+
+#ifndef OLIVER_JIT
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#define OLIVER_JIT 1
+#else
+#define OLIVER_JIT 0
+#endif
+#endif
+
+#if OLIVER_JIT
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <sys/mman.h>
+
+#include "../Compiler/compiler.h"
+
+namespace Olly {
+    namespace eval {
+
+        class evaluator;
+
+        /********************************************************************************************/
+        //
+        //                                  'jit' class definition
+        //
+        //        The jit class counts the calls made to each lambda body, and once a
+        //        body is hot compiles it to x86-64 machine code.  Each term of the body
+        //        is a copy of one template, a call to the runtime helper chosen for
+        //        the term, with the evaluator and the term patched in.  Fetching the
+        //        term, testing its type, and dispatching on its op code are removed.
+        //
+        //        A helper returns false, having done nothing, when its term must be
+        //        left to the interpreter.  The compiled code then returns the index
+        //        of that term, and the evaluator schedules the rest of the body.
+        //        The compiled code has no unwind information, so no exception may
+        //        leave a helper.  One thrown by a helper is caught and kept, and the
+        //        helper returns false.  Once the code has returned, the body is left
+        //        to the interpreter and the exception is thrown again.
+        //
+        //        At most CAPACITY bodies are tracked.  Once there are that many, the
+        //        half called least often are evicted, with their code.
+        //
+        /********************************************************************************************/
+
+        class jit {
+        public:
+
+            typedef     bool_type (*helper_type)(evaluator* e, const let* term);
+            typedef     size_type (*code_type)(evaluator* e);
+            typedef     helper_type (*select_type)(const let& term);
+
+            struct function {
+                let                 body;       // Held so that the body's address is not reused.
+                std::vector<let>    terms;      // The terms passed to the helpers.
+                std::vector<let>    tails;      // The code remaining from each term.
+                size_type           calls;
+                bool_type           failed;
+                void*               code;
+                size_type           size;
+            };
+
+            static const size_type THRESHOLD;
+            static const size_type CAPACITY;
+
+            jit();
+            virtual ~jit();
+
+            const function* get(const let& body, select_type select);
+            void        discard(const let& body);
+
+            size_type compiled() const;
+            size_type  evicted() const;
+
+        private:
+
+            typedef     std::vector<std::uint8_t>   bytes_type;
+
+            std::map<const void*, function> _functions;
+
+            size_type   _compiled;      // The bodies compiled.
+            size_type    _evicted;      // The bodies evicted to keep within CAPACITY.
+
+            jit(const jit& obj) = delete;
+
+            void compile(function& f, select_type select);
+            void evict();
+            static void release(function& f);
+
+            static void emit(bytes_type& code, std::initializer_list<std::uint8_t> bytes);
+            static void emit_imm32(bytes_type& code, std::uint32_t value);
+            static void emit_imm64(bytes_type& code, std::uint64_t value);
+        };
+
+
+
+        const size_type jit::THRESHOLD = 50;
+        const size_type jit::CAPACITY  = 256;
+
+        jit::jit() : _functions(), _compiled(0), _evicted(0) {
+        }
+
+        jit::~jit() {
+
+            for (auto& f : _functions) {
+                release(f.second);
+            }
+        }
+
+        const jit::function* jit::get(const let& body, select_type select) {
+            /*
+                Return the compiled code of a lambda body, or null
+                while the body is cold or if it can not be compiled.
+            */
+
+            const void* key = body.cast<expression>();
+
+            if (!key) {
+                return nullptr;
+            }
+
+            auto itr = _functions.find(key);
+
+            if (itr == _functions.end()) {
+
+                if (_functions.size() >= CAPACITY) {
+                    evict();
+                }
+
+                itr = _functions.emplace(key, function{ body, {}, {}, 0, false, nullptr, 0 }).first;
+            }
+
+            function& f = itr->second;
+
+            ++f.calls;
+
+            if (f.code) {
+                return &f;
+            }
+
+            if (f.failed || f.calls <= THRESHOLD) {
+                return nullptr;
+            }
+
+            compile(f, select);
+
+            if (!f.code) {
+                return nullptr;
+            }
+
+            ++_compiled;
+
+            return &f;
+        }
+
+        void jit::discard(const let& body) {
+            /*
+                Leave a body to the interpreter from now on.
+            */
+
+            auto itr = _functions.find(body.cast<expression>());
+
+            if (itr != _functions.end()) {
+
+                release(itr->second);
+
+                itr->second.failed = true;
+            }
+        }
+
+        size_type jit::compiled() const {
+            return _compiled;
+        }
+
+        size_type jit::evicted() const {
+            return _evicted;
+        }
+
+        void jit::evict() {
+            /*
+                Evict the half of the bodies called least often.
+                No compiled code is running, as 'get' is only
+                called by the interpreter.
+            */
+
+            std::vector<size_type> calls;
+
+            for (const auto& f : _functions) {
+                calls.push_back(f.second.calls);
+            }
+
+            auto mid = calls.begin() + calls.size() / 2;
+
+            std::nth_element(calls.begin(), mid, calls.end());
+
+            size_type below = *mid;
+            size_type count = calls.size() - calls.size() / 2;
+
+            for (auto itr = _functions.begin(); itr != _functions.end() && count; ) {
+
+                if (itr->second.calls <= below) {
+
+                    release(itr->second);
+
+                    itr = _functions.erase(itr);
+
+                    ++_evicted;
+                    --count;
+                }
+                else {
+                    ++itr;
+                }
+            }
+        }
+
+        void jit::release(function& f) {
+
+            if (f.code) {
+                munmap(f.code, f.size);
+            }
+
+            f.code = nullptr;
+            f.size = 0;
+        }
+
+        void jit::compile(function& f, select_type select) {
+
+            let exp = f.body;
+
+            while (exp.is()) {
+
+                f.tails.push_back(exp);
+                f.terms.push_back(pop_lead(exp));
+            }
+
+            std::vector<helper_type> helpers;
+
+            for (const auto& term : f.terms) {
+
+                helper_type helper = select(term);
+
+                if (!helper) {
+                    f.failed = true;
+                    return;
+                }
+
+                helpers.push_back(helper);
+            }
+
+            bytes_type code;
+
+            emit(code, { 0x53 });                           // push rbx
+            emit(code, { 0x48, 0x89, 0xFB });               // mov  rbx, rdi
+
+            for (size_type i = 0; i < f.terms.size(); ++i) {
+
+                emit(code, { 0x48, 0x89, 0xDF });           // mov  rdi, rbx
+                emit(code, { 0x48, 0xBE });                 // mov  rsi, &term
+                emit_imm64(code, reinterpret_cast<std::uint64_t>(&f.terms[i]));
+                emit(code, { 0x48, 0xB8 });                 // mov  rax, helper
+                emit_imm64(code, reinterpret_cast<std::uint64_t>(helpers[i]));
+                emit(code, { 0xFF, 0xD0 });                 // call rax
+                emit(code, { 0x84, 0xC0 });                 // test al, al
+                emit(code, { 0x75, 0x07 });                 // jnz  next
+                emit(code, { 0xB8 });                       // mov  eax, i
+                emit_imm32(code, static_cast<std::uint32_t>(i));
+                emit(code, { 0x5B, 0xC3 });                 // pop  rbx; ret
+            }
+
+            emit(code, { 0xB8 });                           // mov  eax, size
+            emit_imm32(code, static_cast<std::uint32_t>(f.terms.size()));
+            emit(code, { 0x5B, 0xC3 });                     // pop  rbx; ret
+
+            void* mem = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (mem == MAP_FAILED) {
+                f.failed = true;
+                return;
+            }
+
+            std::memcpy(mem, code.data(), code.size());
+
+            if (mprotect(mem, code.size(), PROT_READ | PROT_EXEC) != 0) {
+
+                munmap(mem, code.size());
+
+                f.failed = true;
+                return;
+            }
+
+            f.code = mem;
+            f.size = code.size();
+        }
+
+        void jit::emit(bytes_type& code, std::initializer_list<std::uint8_t> bytes) {
+            code.insert(code.end(), bytes.begin(), bytes.end());
+        }
+
+        void jit::emit_imm32(bytes_type& code, std::uint32_t value) {
+
+            for (size_type i = 0; i < 4; ++i) {
+                code.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+            }
+        }
+
+        void jit::emit_imm64(bytes_type& code, std::uint64_t value) {
+
+            for (size_type i = 0; i < 8; ++i) {
+                code.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+            }
+        }
+
+    }  // end eval
+} // end Olly
+
+#endif
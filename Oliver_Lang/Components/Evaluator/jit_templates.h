@@ -0,0 +1,259 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include "evaluator.h"
+
+#if OLIVER_JIT
+
+namespace Olly {
+    namespace eval {
+
+        /********************************************************************************************/
+        //
+        //                                  JIT Runtime Helpers
+        //
+        //          The helpers called by the code compiled for hot lambdas.  A body is
+        //          only compiled when every one of its terms has a helper, and only
+        //          operators which never schedule code of their own are given one.
+        //          Each helper is called through 'jit_guard', so that no exception
+        //          leaves it.
+        //
+        /********************************************************************************************/
+
+        inline bool_type evaluator::run_compiled(const let& body) {
+            /*
+                Run the compiled code of a lambda body, if it has
+                any, then schedule what is left of the body after
+                the term at which the code stopped.
+            */
+
+            const jit::function* f = _jit.get(body, &jit_template);
+
+            if (!f) {
+                return false;
+            }
+
+            size_type stop = reinterpret_cast<jit::code_type>(f->code)(this);
+
+            if (_jit_error) {
+                /*
+                    A helper threw.  The code has returned, so the
+                    exception is thrown again from here, and the
+                    body is left to the interpreter from now on.
+                */
+
+                std::exception_ptr error = _jit_error;
+
+                _jit_error = nullptr;
+
+                _jit.discard(body);
+
+                std::rethrow_exception(error);
+            }
+
+            /*
+                The terms run by the compiled code count toward the
+                next check of the limits.
+            */
+
+            _countdown -= std::min(stop, _countdown - 1);
+
+            if (stop < f->tails.size()) {
+                set_expression_on_code(f->tails[stop]);
+            }
+
+            return true;
+        }
+
+        inline jit::helper_type evaluator::jit_template(const let& term) {
+
+            str_type type = term.type();
+
+            if (type == "number" || type == "string" || type == "boolean" || type == "list") {
+                return &jit_guard<&jit_push>;
+            }
+
+            if (type == "symbol") {
+                return &jit_guard<&jit_symbol>;
+            }
+
+            if (type != "op_call") {
+                return nullptr;
+            }
+
+            OP_CODE opr = term.op_code();
+
+            if (opr > OP_CODE::UNARY_OPERATORS && opr < OP_CODE::BINARY_OPERATORS) {
+                return &jit_guard<&jit_binary>;
+            }
+
+            if (opr > OP_CODE::SEQUENTIAL_OPERATORS && opr < OP_CODE::ASSOCIATIVE_OPERATORS) {
+                return &jit_guard<&jit_operator>;
+            }
+
+            switch (opr) {
+
+            case OP_CODE::STACK_op:
+            case OP_CODE::EMIT_op:
+            case OP_CODE::ENDL_op:
+            case OP_CODE::LEAD_op:
+            case OP_CODE::LAST_op:
+            case OP_CODE::PLACE_LEAD_op:
+            case OP_CODE::PLACE_LAST_op:
+            case OP_CODE::DROP_LAST_op:
+                return &jit_guard<&jit_operator>;
+
+            case OP_CODE::DROP_LEAD_op:
+                return &jit_guard<&jit_drop_lead>;
+
+            case OP_CODE::SYMBOL_ADD_op:
+                return &jit_guard<&jit_symbol_add>;
+
+            case OP_CODE::LET_CONST_op:
+                return &jit_guard<&jit_let_const>;
+
+            default:
+                break;
+            }
+
+            return nullptr;
+        }
+
+        template<jit::helper_type helper>
+        inline bool_type evaluator::jit_guard(evaluator* e, const let* term) noexcept {
+            /*
+                Run a helper, keeping any exception it throws in
+                place of letting it unwind through compiled code.
+            */
+
+            try {
+                return helper(e, term);
+            }
+            catch (...) {
+                e->_jit_error = std::current_exception();
+            }
+
+            return false;
+        }
+
+        inline bool_type evaluator::jit_push(evaluator* e, const let* term) {
+
+            e->set_expression_on_stack(*term);
+
+            return true;
+        }
+
+        inline bool_type evaluator::jit_symbol(evaluator* e, const let* term) {
+            /*
+                A symbol whose value is a lambda or an expression
+                is left to the interpreter.
+            */
+
+            let val = *term;
+
+            while (val.type() == "symbol") {
+                val = e->get_symbol(val);
+            }
+
+            if (val.type() == "expression" || val.type() == "lambda") {
+                return false;
+            }
+
+            e->set_expression_on_stack(val);
+
+            return true;
+        }
+
+        inline bool_type evaluator::jit_binary(evaluator* e, const let* term) {
+
+            OP_CODE opr = term->op_code();
+
+            e->binary_operators(opr, *term);
+
+            return true;
+        }
+
+        inline bool_type evaluator::jit_operator(evaluator* e, const let* term) {
+
+            e->dispatch(term->op_code(), *term);
+
+            return true;
+        }
+
+        inline bool_type evaluator::jit_drop_lead(evaluator* e, const let* term) {
+            /*
+                Stepping a generated sequence calls its lambda, and
+                so is left to the interpreter.
+            */
+
+            if (!e->_stack.empty()) {
+
+                const sequence* seq = e->_stack.back().cast<sequence>();
+
+                if (seq && seq->generator().is_something()) {
+                    return false;
+                }
+            }
+
+            e->dispatch(term->op_code(), *term);
+
+            return true;
+        }
+
+        inline bool_type evaluator::jit_symbol_add(evaluator* e, const let* term) {
+
+            let val = term->lead();
+
+            while (val.type() == "symbol") {
+                val = e->get_symbol(val);
+            }
+
+            if (val.type() == "expression" || val.type() == "lambda") {
+                return false;
+            }
+
+            e->set_expression_on_stack(val);
+
+            OP_CODE add = OP_CODE::ADD_op;
+
+            e->binary_operators(add, *term);
+
+            return true;
+        }
+
+        inline bool_type evaluator::jit_let_const(evaluator* e, const let* term) {
+
+            let args = term->lead();
+
+            let var = pop_lead(args);
+            let val = pop_lead(args);
+
+            e->set_symbol(var, val);
+
+            return true;
+        }
+
+    }  // end eval
+} // end Olly
+
+#endif
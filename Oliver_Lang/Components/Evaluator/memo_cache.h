@@ -0,0 +1,256 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+#include "../Compiler/compiler.h"
+
+namespace Olly {
+    namespace eval {
+
+        /********************************************************************************************/
+        //
+        //                                'memo_cache' class definition
+        //
+        //        The memo_cache class holds the results of calls to lambdas marked with
+        //        'memo'.  Entries are keyed by the identity of the lambda and a hash of
+        //        the structure of its arguments, and the least recently used entry is
+        //        dropped once the cache is full.  An entry holds its lambda, so that
+        //        the lambda's address is not reused while the entry exists.
+        //
+        /********************************************************************************************/
+
+        class memo_cache {
+        public:
+
+            typedef     std::vector<let>    values_type;
+
+        private:
+
+            struct entry {
+                size_type       key;
+                let             lam;
+                values_type     args;
+                values_type     result;
+            };
+
+            typedef     std::list<entry>                                        entries_type;
+            typedef     std::unordered_map<size_type, entries_type::iterator>   index_type;
+
+            entries_type    _entries;       // Ordered from the most to the least recently used.
+            index_type      _index;
+            size_type       _capacity;
+            size_type       _hits;
+            size_type       _misses;
+
+        public:
+
+            static const size_type DEFAULT_CAPACITY;
+
+            memo_cache();
+            memo_cache(size_type capacity);
+            virtual ~memo_cache();
+
+            const values_type* find(const let& lam, const values_type& args);
+            void store(const let& lam, values_type args, values_type result);
+
+            size_type hits() const;
+            size_type misses() const;
+            size_type size() const;
+
+            void clear();
+
+            static size_type hash(const let& value);
+
+        private:
+
+            memo_cache(const memo_cache& obj) = delete;
+
+            static size_type key(const let& lam, const values_type& args);
+            static size_type combine(size_type seed, size_type value);
+        };
+
+
+
+        const size_type memo_cache::DEFAULT_CAPACITY = 1024;
+
+        memo_cache::memo_cache() : _entries(), _index(), _capacity(DEFAULT_CAPACITY), _hits(0), _misses(0) {
+        }
+
+        memo_cache::memo_cache(size_type capacity) : _entries(), _index(), _capacity(capacity), _hits(0), _misses(0) {
+        }
+
+        memo_cache::~memo_cache() {
+        }
+
+        inline const memo_cache::values_type* memo_cache::find(const let& lam, const values_type& args) {
+            /*
+                Return the result of an earlier call with the same
+                arguments, or null.  A hash which matches an entry
+                of another call is counted as a miss.
+            */
+
+            auto itr = _index.find(key(lam, args));
+
+            if (itr != _index.end()) {
+
+                entry& e = *itr->second;
+
+                bool_type same = e.lam.cast<lambda>() == lam.cast<lambda>() && e.args.size() == args.size();
+
+                for (size_type i = 0; same && i < args.size(); ++i) {
+                    same = e.args[i].type() == args[i].type() && e.args[i] == args[i];
+                }
+
+                if (same) {
+
+                    _entries.splice(_entries.begin(), _entries, itr->second);
+
+                    _hits += 1;
+
+                    return &e.result;
+                }
+            }
+
+            _misses += 1;
+
+            return nullptr;
+        }
+
+        inline void memo_cache::store(const let& lam, values_type args, values_type result) {
+
+            if (!_capacity) {
+                return;
+            }
+
+            size_type k = key(lam, args);
+
+            auto itr = _index.find(k);
+
+            if (itr != _index.end()) {
+
+                _entries.erase(itr->second);
+                _index.erase(itr);
+            }
+
+            if (_entries.size() >= _capacity) {
+
+                _index.erase(_entries.back().key);
+                _entries.pop_back();
+            }
+
+            _entries.push_front(entry{ k, lam, std::move(args), std::move(result) });
+
+            _index[k] = _entries.begin();
+        }
+
+        inline size_type memo_cache::hits() const {
+            return _hits;
+        }
+
+        inline size_type memo_cache::misses() const {
+            return _misses;
+        }
+
+        inline size_type memo_cache::size() const {
+            return _entries.size();
+        }
+
+        inline void memo_cache::clear() {
+
+            _entries.clear();
+            _index.clear();
+
+            _hits   = 0;
+            _misses = 0;
+        }
+
+        inline size_type memo_cache::hash(const let& value) {
+            /*
+                Hash a value by its structure.  Sequences combine
+                the hashes of their elements, so equal values hash
+                alike whichever cells they are built from.
+            */
+
+            str_type type = value.type();
+
+            size_type seed = std::hash<str_type>()(type);
+
+            if (type == "number") {
+
+                const number* n = value.cast<number>();
+
+                seed = combine(seed, std::hash<real_type>()(n->real()));
+                seed = combine(seed, std::hash<real_type>()(n->imag()));
+            }
+
+            else if (type == "boolean") {
+
+                const boolean* b = value.cast<boolean>();
+
+                seed = combine(seed, std::hash<real_type>()(b->term()));
+                seed = combine(seed, std::hash<real_type>()(b->weight()));
+            }
+
+            else if (type == "string" || type == "symbol") {
+                seed = combine(seed, std::hash<str_type>()(str(value)));
+            }
+
+            else if (type == "list" || type == "expression") {
+
+                let items = value;
+
+                while (items.is()) {
+
+                    seed = combine(seed, hash(items.lead()));
+
+                    items = items.drop_lead();
+                }
+            }
+
+            else {
+                seed = combine(seed, std::hash<str_type>()(repr(value)));
+            }
+
+            return seed;
+        }
+
+        inline size_type memo_cache::key(const let& lam, const values_type& args) {
+
+            size_type seed = std::hash<const void*>()(lam.cast<lambda>());
+
+            for (const auto& arg : args) {
+                seed = combine(seed, hash(arg));
+            }
+
+            return seed;
+        }
+
+        inline size_type memo_cache::combine(size_type seed, size_type value) {
+            return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+        }
+
+    }  // end eval
+} // end Olly
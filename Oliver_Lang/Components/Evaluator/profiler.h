@@ -0,0 +1,314 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+/*
+    The profiler is built only when OLIVER_PROFILE is defined as 1.
+    Else the evaluator has no profiling code at all.
+*/
+
+#ifndef OLIVER_PROFILE
+#define OLIVER_PROFILE 0
+#endif
+
+#if OLIVER_PROFILE
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+
+#include "../Compiler/compiler.h"
+
+namespace Olly {
+    namespace eval {
+
+        /********************************************************************************************/
+        //
+        //                                'profiler' class definition
+        //
+        //        The profiler class counts the operators dispatched by an evaluator and
+        //        the time spent in each, and the calls made to each lambda with their
+        //        inclusive and exclusive time.  A lambda is known by its body, which is
+        //        shared by every copy of the lambda made from its definition, and is
+        //        named by the symbol it was first called through.
+        //
+        //        A call is open from when the lambda's scope is made until the scope
+        //        at the same depth is deleted.  A tail call takes over the scope of
+        //        its caller, and so ends the caller's call.  Exclusive time is kept by
+        //        stack too, for flame graphs.
+        //
+        /********************************************************************************************/
+
+        class profiler {
+        public:
+
+            typedef     std::uint64_t   tick_type;      // Nanoseconds.
+
+            struct op_entry {
+                size_type   count;
+                tick_type   total;
+            };
+
+            struct lambda_entry {
+                let         body;       // Held so that the body's address is not reused.
+                str_type    name;
+                size_type   calls;
+                tick_type   inclusive;
+                tick_type   exclusive;
+            };
+
+        private:
+
+            struct frame {
+                lambda_entry*   entry;
+                str_type        path;       // The names of the open calls, separated by ';'.
+                size_type       depth;      // The depth of the call's scope.
+                tick_type       start;
+                tick_type       children;   // The time spent in calls made by this call.
+            };
+
+            std::vector<op_entry>                   _ops;
+            std::map<const void*, lambda_entry>     _lambdas;
+            std::vector<frame>                      _frames;
+            std::map<str_type, tick_type>           _stacks;
+            lambda_entry                            _program;
+
+        public:
+
+            static const str_type PROGRAM;
+
+            profiler();
+            virtual ~profiler();
+
+            static tick_type now();
+
+            void count_op(OP_CODE opr, tick_type elapsed);
+
+            void begin();
+            void enter(const let& lam, const str_type& name, size_type depth);
+            void leave(size_type depth);
+            void end();
+
+            void clear();
+
+            str_type report(size_type top) const;
+            str_type collapsed() const;
+
+        private:
+
+            profiler(const profiler& obj) = delete;
+
+            void close();
+        };
+
+
+
+        const str_type profiler::PROGRAM = "program";
+
+        profiler::profiler() : _ops(static_cast<size_type>(OP_CODE::END_OPERATORS_OP) + 1, op_entry{ 0, 0 }),
+            _lambdas(), _frames(), _stacks(), _program{ let(), PROGRAM, 0, 0, 0 } {
+        }
+
+        profiler::~profiler() {
+        }
+
+        inline profiler::tick_type profiler::now() {
+            return static_cast<tick_type>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        inline void profiler::count_op(OP_CODE opr, tick_type elapsed) {
+
+            op_entry& e = _ops[static_cast<size_type>(opr)];
+
+            e.count += 1;
+            e.total += elapsed;
+        }
+
+        inline void profiler::begin() {
+            /*
+                Open the call of the program itself, below any
+                lambda's scope.
+            */
+
+            _program.calls += 1;
+
+            _frames.push_back(frame{ &_program, PROGRAM, 0, now(), 0 });
+        }
+
+        inline void profiler::enter(const let& lam, const str_type& name, size_type depth) {
+
+            leave(depth);
+
+            let body = lam.last();
+
+            const void* key = body.cast<expression>();
+
+            if (!key) {
+                key = lam.cast<lambda>();
+            }
+
+            auto itr = _lambdas.find(key);
+
+            if (itr == _lambdas.end()) {
+
+                str_type label = name.empty() ? repr(lam).substr(0, 32) : name;
+
+                std::replace(label.begin(), label.end(), ';', ',');
+
+                itr = _lambdas.emplace(key, lambda_entry{ body, label, 0, 0, 0 }).first;
+            }
+
+            lambda_entry& e = itr->second;
+
+            e.calls += 1;
+
+            str_type path = _frames.empty() ? e.name : _frames.back().path + ";" + e.name;
+
+            _frames.push_back(frame{ &e, std::move(path), depth, now(), 0 });
+        }
+
+        inline void profiler::leave(size_type depth) {
+            /*
+                End the calls whose scopes are at or above 'depth'.
+            */
+
+            while (!_frames.empty() && _frames.back().depth >= depth && _frames.back().entry != &_program) {
+                close();
+            }
+        }
+
+        inline void profiler::end() {
+
+            while (!_frames.empty()) {
+                close();
+            }
+        }
+
+        inline void profiler::close() {
+
+            frame f = std::move(_frames.back());
+            _frames.pop_back();
+
+            tick_type inclusive = now() - f.start;
+            tick_type exclusive = inclusive > f.children ? inclusive - f.children : 0;
+
+            f.entry->inclusive += inclusive;
+            f.entry->exclusive += exclusive;
+
+            _stacks[f.path] += exclusive;
+
+            if (!_frames.empty()) {
+                _frames.back().children += inclusive;
+            }
+        }
+
+        inline void profiler::clear() {
+
+            std::fill(_ops.begin(), _ops.end(), op_entry{ 0, 0 });
+
+            _lambdas.clear();
+            _frames.clear();
+            _stacks.clear();
+
+            _program = lambda_entry{ let(), PROGRAM, 0, 0, 0 };
+        }
+
+        inline str_type profiler::report(size_type top) const {
+            /*
+                The operators and the lambdas which took the most
+                time, most first.
+            */
+
+            std::vector<size_type> ops;
+
+            for (size_type i = 0; i < _ops.size(); ++i) {
+
+                if (_ops[i].count) {
+                    ops.push_back(i);
+                }
+            }
+
+            std::sort(ops.begin(), ops.end(), [this](size_type a, size_type b) { return _ops[a].total > _ops[b].total; });
+
+            std::vector<const lambda_entry*> lambdas;
+
+            if (_program.calls) {
+                lambdas.push_back(&_program);
+            }
+
+            for (const auto& l : _lambdas) {
+                lambdas.push_back(&l.second);
+            }
+
+            std::sort(lambdas.begin(), lambdas.end(), [](const lambda_entry* a, const lambda_entry* b) { return a->exclusive > b->exclusive; });
+
+            stream_type out;
+
+            out << std::left << std::setw(24) << "operator" << std::right << std::setw(12) << "count" << std::setw(14) << "total us" << std::setw(12) << "mean ns" << std::endl;
+
+            for (size_type i = 0; i < ops.size() && i < top; ++i) {
+
+                const op_entry& e = _ops[ops[i]];
+
+                out << std::left << std::setw(24) << str(op_call(static_cast<OP_CODE>(ops[i])))
+                    << std::right << std::setw(12) << e.count
+                    << std::setw(14) << e.total / 1000
+                    << std::setw(12) << e.total / e.count << std::endl;
+            }
+
+            out << std::endl;
+
+            out << std::left << std::setw(24) << "lambda" << std::right << std::setw(12) << "calls" << std::setw(14) << "inclusive us" << std::setw(14) << "exclusive us" << std::endl;
+
+            for (size_type i = 0; i < lambdas.size() && i < top; ++i) {
+
+                const lambda_entry& e = *lambdas[i];
+
+                out << std::left << std::setw(24) << e.name
+                    << std::right << std::setw(12) << e.calls
+                    << std::setw(14) << e.inclusive / 1000
+                    << std::setw(14) << e.exclusive / 1000 << std::endl;
+            }
+
+            return out.str();
+        }
+
+        inline str_type profiler::collapsed() const {
+            /*
+                One line for each stack of calls, the names of the
+                calls separated by ';' followed by the exclusive
+                time in nanoseconds, as read by flamegraph.pl.
+            */
+
+            stream_type out;
+
+            for (const auto& s : _stacks) {
+                out << s.first << " " << s.second << std::endl;
+            }
+
+            return out.str();
+        }
+
+    }  // end eval
+} // end Olly
+
+#endif
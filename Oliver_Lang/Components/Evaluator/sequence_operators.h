@@ -26,7 +26,7 @@
 namespace Olly {
     namespace eval {
 
-        inline void evaluator::sequence_operators(OP_CODE& opr) {
+        inline void evaluator::sequence_operators(OP_CODE& opr, const let& site) {
 
             switch (opr) {
 
@@ -85,7 +85,8 @@ namespace Olly {
 
                 if (op_code == OP_CODE::LEAD_op) {
 
-                    x = x.drop_lead();
+                    drop_lead(x);
+                    break;
                 }
                 else if (op_code == OP_CODE::LAST_op) {
 
@@ -103,11 +104,7 @@ namespace Olly {
 
                 let x = get_expression_from_code();
 
-                let place = op_call(OP_CODE::PLACE_op);
-                let lead  = op_call(OP_CODE::LEAD_op);
-
-                set_expression_on_code(lead);
-                set_expression_on_code(place);
+                set_expression_on_code(get_op_call(OP_CODE::PLACE_LEAD_op));
                 set_expression_on_code(x);
 
             }   break;
@@ -116,11 +113,7 @@ namespace Olly {
 
                 let x = get_expression_from_code();
 
-                let place = op_call(OP_CODE::PLACE_op);
-                let last = op_call(OP_CODE::LAST_op);
-
-                set_expression_on_code(last);
-                set_expression_on_code(place);
+                set_expression_on_code(get_op_call(OP_CODE::PLACE_LAST_op));
                 set_expression_on_code(x);
 
             }   break;
@@ -129,22 +122,85 @@ namespace Olly {
 
                 let x = get_expression_from_code();
 
-                let drop = op_call(OP_CODE::DROP_op);
-                let lead = op_call(OP_CODE::LEAD_op);
-
-                set_expression_on_code(lead);
-                set_expression_on_code(drop);
+                set_expression_on_code(get_op_call(OP_CODE::DROP_LEAD_op));
                 set_expression_on_code(x);
 
             }   break;
 
             case OP_CODE::drop_last_op: {
 
-                let drop = op_call(OP_CODE::DROP_op);
-                let last = op_call(OP_CODE::LAST_op);
+                set_expression_on_code(get_op_call(OP_CODE::DROP_LAST_op));
+
+            }   break;
+
+            case OP_CODE::range_op: {  // A lazy range of numbers from the first up to the second.
+
+                let start = get_expression_from_code();
+                let stop  = get_expression_from_code();
+
+                while (start.type() == "symbol") {
+                    start = get_symbol(start);
+                }
+
+                while (stop.type() == "symbol") {
+                    stop = get_symbol(stop);
+                }
+
+                const number* a = start.cast<number>();
+                const number* b = stop.cast<number>();
+
+                if (a && b) {
+                    set_expression_on_stack(sequence(a->real(), b->real(), 1.0));
+                }
+                else {
+                    set_expression_on_stack(error("A range is bounded by two numbers."));
+                }
+
+            }   break;
+
+            case OP_CODE::generate_op: {  // A lazy sequence from a lambda and its first element.
+
+                let gen  = get_expression_from_code();
+                let seed = get_expression_from_code();
+
+                while (gen.type() == "symbol") {
+                    gen = get_symbol(gen);
+                }
+
+                while (seed.type() == "symbol") {
+                    seed = get_symbol(seed);
+                }
 
-                set_expression_on_code(last);
-                set_expression_on_code(drop);
+                if (gen.type() == "lambda") {
+                    set_expression_on_stack(sequence(seed, gen));
+                }
+                else {
+                    set_expression_on_stack(error("A sequence is generated by a lambda."));
+                }
+
+            }   break;
+
+            case OP_CODE::generate_next_op: {
+                /*
+                    The generator has returned the next element of its
+                    sequence, or has returned nothing and so ended it.
+                    The height of the stack when it was called is the
+                    second argument of the site.
+                */
+
+                let args = site.lead();
+
+                let gen = pop_lead(args);
+
+                size_type height = static_cast<size_type>(args.lead().cast<number>()->real());
+
+                let val = nothing();
+
+                if (_stack.size() > height) {
+                    val = get_expression_from_stack();
+                }
+
+                set_expression_on_stack(sequence(val, gen));
 
             }   break;
 
@@ -153,5 +209,29 @@ namespace Olly {
             }
         }
 
+        inline void evaluator::drop_lead(const let& x) {
+            /*
+                Drop the lead of a sequence.  A generated sequence
+                steps by calling its lambda with its current element,
+                so the call is scheduled and the sequence is rebuilt
+                from the result by 'generate_next_op'.
+            */
+
+            const sequence* seq = x.cast<sequence>();
+
+            if (seq && seq->generator().is_something() && x.is()) {
+
+                let args = let(expression(number(_stack.size()))).place_lead(seq->generator());
+
+                set_expression_on_code(op_call(OP_CODE::generate_next_op, args));
+                set_expression_on_code(seq->value());
+                set_expression_on_code(seq->generator());
+
+                return;
+            }
+
+            set_expression_on_stack(x.drop_lead());
+        }
+
     }  // end eval
 } // end Olly
\ No newline at end of file
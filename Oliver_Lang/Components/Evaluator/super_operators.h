@@ -0,0 +1,175 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include "evaluator.h"
+
+namespace Olly {
+    namespace eval {
+
+        /********************************************************************************************/
+        //
+        //                                  Superinstructions
+        //
+        //          Each superinstruction performs the work of a short sequence of
+        //          operators in a single dispatch.  They are written by the optimizer,
+        //          and by the sequence operators when expanding '-->', '<--' and '>>>'.
+        //          Any arguments fused in to the instruction are its lead.
+        //
+        /********************************************************************************************/
+
+        inline void evaluator::super_operators(OP_CODE& opr, const let& site) {
+
+            switch (opr) {
+
+            case OP_CODE::PLACE_LEAD_op: {  // PLACE LEAD
+
+                let y = get_expression_from_stack();
+                let x = get_expression_from_stack();
+
+                set_expression_on_stack(y.place_lead(x));
+
+            }   break;
+
+            case OP_CODE::PLACE_LAST_op: {  // PLACE LAST
+
+                let y = get_expression_from_stack();
+                let x = get_expression_from_stack();
+
+                set_expression_on_stack(x.place_last(y));
+
+            }   break;
+
+            case OP_CODE::DROP_LEAD_op: {  // DROP LEAD
+
+                let x = get_expression_from_stack();
+
+                drop_lead(x);
+
+            }   break;
+
+            case OP_CODE::DROP_LAST_op: {  // DROP LAST
+
+                let x = get_expression_from_stack();
+
+                set_expression_on_stack(x.drop_last());
+
+            }   break;
+
+            case OP_CODE::SYMBOL_ADD_op: {  // symbol ADD
+
+                let var = site.lead();
+                let val = var;
+
+                while (val.type() == "symbol") {
+                    val = get_symbol(val);
+                }
+
+                if (val.type() == "expression" || val.type() == "lambda") {
+                    /*
+                        Values which are evaluated rather than pushed
+                        are handed back to the evaluator unfused.
+                    */
+
+                    set_expression_on_code(get_op_call(OP_CODE::ADD_op));
+                    set_expression_on_code(var);
+                    break;
+                }
+
+                set_expression_on_stack(val);
+
+                OP_CODE add = OP_CODE::ADD_op;
+
+                binary_operators(add, site);
+
+            }   break;
+
+            case OP_CODE::LET_CONST_op: {  // let symbol literal EQ
+
+                let args = site.lead();
+
+                let var = pop_lead(args);
+                let val = pop_lead(args);
+
+                set_symbol(var, val);
+
+            }   break;
+
+            default:
+                break;
+            }
+        }
+
+        inline void evaluator::unfuse(const let& site) {
+            /*
+                Place the terms a superinstruction was fused from
+                back on to the code.  A lambda's arguments are read
+                from the code term by term, so one of them may have
+                been fused with the terms which follow it.
+            */
+
+            switch (site.op_code()) {
+
+            case OP_CODE::PLACE_LEAD_op:
+                set_expression_on_code(get_op_call(OP_CODE::LEAD_op));
+                set_expression_on_code(get_op_call(OP_CODE::PLACE_op));
+                break;
+
+            case OP_CODE::PLACE_LAST_op:
+                set_expression_on_code(get_op_call(OP_CODE::LAST_op));
+                set_expression_on_code(get_op_call(OP_CODE::PLACE_op));
+                break;
+
+            case OP_CODE::DROP_LEAD_op:
+                set_expression_on_code(get_op_call(OP_CODE::LEAD_op));
+                set_expression_on_code(get_op_call(OP_CODE::DROP_op));
+                break;
+
+            case OP_CODE::DROP_LAST_op:
+                set_expression_on_code(get_op_call(OP_CODE::LAST_op));
+                set_expression_on_code(get_op_call(OP_CODE::DROP_op));
+                break;
+
+            case OP_CODE::SYMBOL_ADD_op:
+                set_expression_on_code(get_op_call(OP_CODE::ADD_op));
+                set_expression_on_code(site.lead());
+                break;
+
+            case OP_CODE::LET_CONST_op: {
+
+                let args = site.lead();
+
+                set_expression_on_code(get_op_call(OP_CODE::EQ_op));
+                set_expression_on_code(args.drop_lead().lead());
+                set_expression_on_code(args.lead());
+                set_expression_on_code(get_op_call(OP_CODE::let_op));
+
+            }   break;
+
+            default:
+                set_expression_on_code(site);
+                break;
+            }
+        }
+
+    }  // end eval
+} // end Olly
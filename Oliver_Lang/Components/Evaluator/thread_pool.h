@@ -0,0 +1,277 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "../Compiler/compiler.h"
+
+namespace Olly {
+    namespace eval {
+
+        /********************************************************************************************/
+        //
+        //                                'thread_pool' class definition
+        //
+        //        The thread_pool class runs tasks on a fixed set of worker threads
+        //        which steal work from one another.  Each worker has a queue of its
+        //        own.  A task given by a worker goes on to the back of that worker's
+        //        queue, and a task given by any other thread goes on to a shared
+        //        queue.  A worker runs the newest task of its own queue first, and
+        //        once that is empty takes the oldest task of another queue.
+        //
+        //        A thread waiting on a task runs other tasks of the pool while it
+        //        waits, so tasks may wait on tasks they gave without deadlock.  Once
+        //        none are queued it sleeps until a task is given or one ends.
+        //
+        /********************************************************************************************/
+
+        class thread_pool {
+
+            typedef     std::function<void()>   task_type;
+
+            struct queue {
+                std::mutex              mutex;
+                std::deque<task_type>   tasks;
+            };
+
+            std::vector<std::unique_ptr<queue>> _queues;    // One for each worker, then the shared queue.
+            std::vector<std::thread>            _workers;
+            std::mutex                          _mutex;
+            std::condition_variable             _ready;     // A task was given, or one has ended.
+            std::atomic<size_type>              _pending;
+            bool_type                           _stop;
+
+            static thread_local thread_pool*    _pool;      // The pool of the calling worker, if any.
+            static thread_local size_type       _index;     // The index of the calling worker in its pool.
+            static size_type                    _shared_size;
+
+        public:
+
+            thread_pool(size_type threads);
+            virtual ~thread_pool();
+
+            std::future<void> submit(task_type task);
+            void wait(std::future<void>& result);
+
+            size_type size() const;
+
+            static thread_pool& shared();
+            static void set_shared_size(size_type threads);
+
+        private:
+
+            thread_pool(const thread_pool& obj) = delete;
+
+            bool_type run_one();
+            void run(size_type index);
+        };
+
+
+
+        thread_local thread_pool* thread_pool::_pool  = nullptr;
+        thread_local size_type    thread_pool::_index = 0;
+        size_type                 thread_pool::_shared_size = 0;
+
+        thread_pool::thread_pool(size_type threads) : _queues(), _workers(), _mutex(), _ready(), _pending(0), _stop(false) {
+
+            for (size_type i = 0; i <= threads; ++i) {
+                _queues.emplace_back(std::make_unique<queue>());
+            }
+
+            for (size_type i = 0; i < threads; ++i) {
+                _workers.emplace_back(&thread_pool::run, this, i);
+            }
+        }
+
+        thread_pool::~thread_pool() {
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                _stop = true;
+            }
+
+            _ready.notify_all();
+
+            for (auto& worker : _workers) {
+                worker.join();
+            }
+        }
+
+        inline std::future<void> thread_pool::submit(task_type task) {
+
+            auto job = std::make_shared<std::packaged_task<void()>>(std::move(task));
+
+            std::future<void> result = job->get_future();
+
+            queue& q = (_pool == this) ? *_queues[_index] : *_queues.back();
+
+            {
+                std::lock_guard<std::mutex> lock(q.mutex);
+
+                q.tasks.emplace_back([this, job]() {
+
+                    (*job)();
+
+                    /*
+                        Wake the threads waiting on a task.  The lock
+                        is taken so that the wake is not lost by one
+                        about to sleep.
+                    */
+
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                    }
+
+                    _ready.notify_all();
+                });
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                _pending += 1;
+            }
+
+            _ready.notify_one();
+
+            return result;
+        }
+
+        inline void thread_pool::wait(std::future<void>& result) {
+
+            auto ready = [&result]() {
+                return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            };
+
+            while (!ready()) {
+
+                if (run_one()) {
+                    continue;
+                }
+
+                /*
+                    No task is queued, so the task waited on is being
+                    run by another thread.
+                */
+
+                std::unique_lock<std::mutex> lock(_mutex);
+
+                _ready.wait(lock, [this, &ready]() { return _pending > 0 || ready(); });
+            }
+
+            result.get();
+        }
+
+        inline size_type thread_pool::size() const {
+            return _workers.size();
+        }
+
+        inline thread_pool& thread_pool::shared() {
+            /*
+                The pool shared by the evaluators of the process.
+                It has a worker for each hardware thread unless a
+                size was set before its first use.
+            */
+
+            static thread_pool pool(_shared_size ? _shared_size : std::max<size_type>(std::thread::hardware_concurrency(), 1));
+
+            return pool;
+        }
+
+        inline void thread_pool::set_shared_size(size_type threads) {
+            _shared_size = threads;
+        }
+
+        inline bool_type thread_pool::run_one() {
+            /*
+                Run the newest task of the caller's own queue, or
+                else steal the oldest task of another queue.
+            */
+
+            size_type self = (_pool == this) ? _index : _queues.size() - 1;
+
+            task_type task;
+
+            for (size_type i = 0; i < _queues.size() && !task; ++i) {
+
+                queue& q = *_queues[(self + i) % _queues.size()];
+
+                std::lock_guard<std::mutex> lock(q.mutex);
+
+                if (q.tasks.empty()) {
+                    continue;
+                }
+
+                if (i == 0) {
+                    task = std::move(q.tasks.back());
+                    q.tasks.pop_back();
+                }
+                else {
+                    task = std::move(q.tasks.front());
+                    q.tasks.pop_front();
+                }
+            }
+
+            if (!task) {
+                return false;
+            }
+
+            _pending -= 1;
+
+            task();
+
+            return true;
+        }
+
+        inline void thread_pool::run(size_type index) {
+
+            _pool  = this;
+            _index = index;
+
+            while (true) {
+
+                if (run_one()) {
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(_mutex);
+
+                _ready.wait(lock, [this]() { return _stop || _pending > 0; });
+
+                if (_stop && _pending == 0) {
+                    return;
+                }
+            }
+        }
+
+    }  // end eval
+} // end Olly
@@ -0,0 +1,220 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#if defined(_WIN32)
+#include <filesystem>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Olly {
+
+    /********************************************************************************************/
+    //
+    //                              'mapped_file' class definition
+    //
+    //        The mapped_file class maps a regular file read only in to memory, and
+    //        views its bytes as one contiguous string.  The pages are read by the
+    //        system as they are first touched, and nothing is copied.  Where files
+    //        are not mapped, or for pipes and devices, the file is read whole in to
+    //        a buffer instead.
+    //
+    /********************************************************************************************/
+
+    class mapped_file {
+
+        const char*     _data;
+        std::size_t     _size;
+        bool            _mapped;    // '_data' is mapped, and is unmapped on destruction.
+        std::string     _buffer;
+
+    public:
+
+        mapped_file();
+        virtual ~mapped_file();
+
+        bool open(const std::string& path);
+
+        std::string_view view() const;
+
+    private:
+
+        mapped_file(const mapped_file& obj) = delete;
+        mapped_file& operator=(const mapped_file& obj) = delete;
+
+        void close();
+
+#if !defined(_WIN32)
+        bool read_all(int fd);
+#endif
+    };
+
+    /********************************************************************************************/
+    //
+    //   mapped_file implimentation.
+    //
+    /********************************************************************************************/
+
+    mapped_file::mapped_file() : _data(nullptr), _size(0), _mapped(false), _buffer() {
+    }
+
+    mapped_file::~mapped_file() {
+        close();
+    }
+
+    inline bool mapped_file::open(const std::string& path) {
+        /*
+            Return false, viewing nothing, if the path is not a
+            file which can be read.  A file which is not regular,
+            such as a pipe, is read in to the buffer.
+        */
+
+        close();
+
+#if defined(_WIN32)
+        std::error_code error;
+
+        if (std::filesystem::is_directory(path, error) || !std::filesystem::exists(path, error)) {
+            return false;
+        }
+
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+
+        if (!file) {
+            return false;
+        }
+
+        _buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+        _data = _buffer.data();
+        _size = _buffer.size();
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat info;
+
+        if (::fstat(fd, &info) != 0 || S_ISDIR(info.st_mode)) {
+            ::close(fd);
+            return false;
+        }
+
+        if (S_ISREG(info.st_mode) && info.st_size > 0) {
+
+            void* p = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (p != MAP_FAILED) {
+
+                ::madvise(p, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+
+                _data   = static_cast<const char*>(p);
+                _size   = static_cast<std::size_t>(info.st_size);
+                _mapped = true;
+
+                ::close(fd);
+
+                return true;
+            }
+        }
+
+        /*
+            A pipe or device can not be mapped, nor can a file
+            which claims no size, such as those of '/proc', so
+            it is read whole in to the buffer instead.
+        */
+
+        bool ok = read_all(fd);
+
+        ::close(fd);
+
+        if (!ok) {
+            _buffer.clear();
+            return false;
+        }
+
+        _data = _buffer.data();
+        _size = _buffer.size();
+#endif
+
+        return true;
+    }
+
+#if !defined(_WIN32)
+    inline bool mapped_file::read_all(int fd) {
+
+        char block[4096];
+
+        while (true) {
+
+            ssize_t n = ::read(fd, block, sizeof(block));
+
+            if (n == 0) {
+                return true;
+            }
+
+            if (n < 0) {
+
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                return false;
+            }
+
+            _buffer.append(block, static_cast<std::size_t>(n));
+        }
+    }
+#endif
+
+    inline std::string_view mapped_file::view() const {
+        return std::string_view(_data ? _data : "", _size);
+    }
+
+    inline void mapped_file::close() {
+
+#if !defined(_WIN32)
+        if (_mapped) {
+            ::munmap(const_cast<char*>(_data), _size);
+        }
+#endif
+
+        _data   = nullptr;
+        _size   = 0;
+        _mapped = false;
+
+        _buffer.clear();
+    }
+
+} // end Olly
@@ -25,6 +25,8 @@
 #include <string>
 #include <vector>
 #include "text_reader.h"
+#include "token.h"
+#include "tracer.h"
 
 namespace Olly {
 
@@ -38,15 +40,30 @@ namespace Olly {
         //        is recognized as invoking special behavior.  Else all words are
         //        defined by being split at whitespace.  
         //
+        //        Each word is a token viewing the text read, so no word is copied.  The
+        //        tokens returned by 'parse' are only valid while the parser is.
+        //
+        //        The parser is also a token_source.  Each call to 'next' reads only as
+        //        far as the next token, so a program may be compiled as it is read,
+        //        holding no more than a few tokens at a time.
+        //
         /********************************************************************************************/
 
         // The regex below is currently not in use.  Will see later integration.  
         // static const regex_t  REAL_REGEX("((\\+|-)?[[:digit:]]+)(\\.(([[:digit:]]+)?))?((e|E)((\\+|-)?)[[:digit:]]+)?", std::regex_constants::ECMAScript | std::regex_constants::optimize);
 
-        class parser {
+        class parser : public token_source {
+
+            enum class STATE { start, reading, done };
 
             text_reader	                _input;    // The lexical code to parse.
-            std::vector<std::string>	_text;	   // The parsed code read from the input.
+            token_list          	    _text;	   // The tokens read from the input and not yet taken.
+            size_type                   _taken;    // The tokens of '_text' already taken.
+            STATE                       _state;
+            bool_type                   _traced;   // Reading is traced as a span, from start to done.
+            tracer::tick_type           _started;
+            size_type                   _word;     // The position of the word being read.
+            size_type                   _size;     // The length of the word being read, zero if there is none.
             bool			            _skip;     // Identifies if a token exists within the bounds of a comment block.
             char                        _c;        // The current character being handled.
 
@@ -55,7 +72,9 @@ namespace Olly {
             parser(std::string input);
             virtual ~parser();
 
-            std::vector<std::string> parse();
+            token_list parse();
+
+            bool_type next(token& t) override;
 
         private:
 
@@ -65,35 +84,38 @@ namespace Olly {
             int is_regex_escape_char(const char& c);
             int is_string_escape_char(const char& c);
 
-            void process_word(std::string& word);
+            void read_char();
+            void process_word();
+            void push(TOKEN_KIND kind, std::string_view text, size_type offset);
 
             void handle_leading_whitespace();
-            void handle_comment_operator(std::string& word);
-            void handle_unary_negation_operator(std::string& word);
-            void handle_unary_addition_operator(std::string& word);
-            void handle_pass_through_operator(std::string& word);
-            void handle_numeric_identifier(std::string& word);
-            void handle_string_identifier(std::string& word);
-            void handle_regex_identifier(std::string& word);
-            void handle_io_format_identifier(std::string& word);
-            void handle_paren_expression_identifier(std::string& word);
-            void handle_colon_expression_identifier(std::string& word);
-            void handle_list_identifier(std::string& word);
-            void handle_map_identifier(std::string& word);
-
-            std::string read_string();
-            std::string read_number();
-            std::string read_format();
-            std::string read_regex();
-            std::string list_op(const char& c);
-            std::string map_op(const char& c);
-            std::string expression_op(const char& c);
+            void handle_comment_operator();
+            void handle_unary_negation_operator();
+            void handle_unary_addition_operator();
+            void handle_pass_through_operator();
+            void handle_numeric_identifier();
+            void handle_string_identifier();
+            void handle_regex_identifier();
+            void handle_io_format_identifier();
+            void handle_paren_expression_identifier();
+            void handle_colon_expression_identifier();
+            void handle_list_identifier();
+            void handle_map_identifier();
+
+            std::string_view read_string();
+            std::string_view read_number();
+            std::string_view read_format();
+            std::string_view read_regex();
+            TOKEN_KIND list_op(const char& c);
+            TOKEN_KIND map_op(const char& c);
+            TOKEN_KIND expression_op(const char& c);
 
             void skip_comment_line();
 
             bool whitespace_char(char c);
-            
-            std::string pop_text();
+
+            size_type position() const;
+            std::string_view source(size_type offset, size_type size) const;
 
             static const std::vector<std::string> ENCLOSURE_WORDS;
         };
@@ -108,108 +130,172 @@ namespace Olly {
             "(", ")", "'", "'", "\"", "\"", "[", "]", "{", "}", "`", "`"
     };
 
-    parser::parser(std::string input) : _input(input), _text(), _skip(false), _c('\0') {
+    parser::parser(std::string input) : _input(input), _text(), _taken(0), _state(STATE::start), _traced(false), _started(0), _word(0), _size(0), _skip(false), _c('\0') {
     }
 
     parser::~parser() {
     }
 
-    std::vector<std::string> parser::parse() {
+    token_list parser::parse() {
         /*
-            Ensure that the file has content to parse.
+            Read every token of the text.
         */
 
-        if (!_input.is()) {
-            return _text;
-        }
+        token_list tokens;
 
-        handle_leading_whitespace();
+        token t;
 
-        std::string  word = "(";
+        while (next(t)) {
+            tokens.push_back(t);
+        }
 
-        process_word(word);
+        return tokens;
+    }
 
-        while (_input.is()) {
-            /*
-                Grab each character and split each group
-                of characters on whitespace or on a few
-                special characters which have a specific
-                semantic meaning.
-            */
+    bool_type parser::next(token& t) {
+        /*
+            Read characters until a token is found.  A
+            character may end a word and be a token too,
+            so the tokens found are kept until taken.
+
+            Text with no content has no tokens.  Else its
+            tokens are enclosed in an expression.  The
+            time from the first token to the last is
+            traced as the parse.
+        */
 
-            _c = _input.next();
+        while (_taken == _text.size()) {
 
-            if (!_skip) {
+            _text.clear();
+            _taken = 0;
 
-                if (whitespace_char(_c) || _c == ',') {
+            if (_state == STATE::done) {
+                return false;
+            }
 
-                    process_word(word);
-                }
+            if (_state == STATE::start) {
 
-                else if (_c == '#') {
-                    handle_comment_operator(word);
+                if (!_input.is()) {
+                    _state = STATE::done;
+                    return false;
                 }
 
-                else if (word == "" && _c == '-') {
-                    handle_unary_negation_operator(word);
-                }
+                _traced = tracer::enabled();
 
-                else if (word == "" && _c == '+') {
-                    handle_unary_addition_operator(word);
+                if (_traced) {
+                    _started = tracer::now();
                 }
 
-                else if (_c == '@') {
-                    handle_pass_through_operator(word);
-                }
+                handle_leading_whitespace();
 
-                else if (_c == '\'') {
-                    handle_numeric_identifier(word);
-                }
+                push(TOKEN_KIND::open_expression, "(", _input.position());
 
-                else if (_c == '"') {
-                    handle_string_identifier(word);
-                }
+                _state = STATE::reading;
+            }
+            else if (_input.is()) {
+                read_char();
+            }
+            else {
+                process_word();
 
-                else if (_c == '\\') {
-                    handle_regex_identifier(word);
-                }
+                push(TOKEN_KIND::close_expression, ")", _input.position());
 
-                else if (_c == '`') {
-                    handle_io_format_identifier(word);
-                }
+                _state = STATE::done;
 
-                else if (_c == '(' || _c == ')') {
-                    handle_paren_expression_identifier(word);
+                if (_traced) {
+                    tracer::complete("parse", "parse", _started, tracer::now());
                 }
+            }
+        }
 
-                else if (_c == ':' || _c == ';') {
-                    handle_colon_expression_identifier(word);
-                }
+        t = _text[_taken++];
 
-                else if (_c == '[' || _c == ']') {
-                    handle_list_identifier(word);
-                }
+        return true;
+    }
 
-                else if (_c == '{' || _c == '}') {
-                    handle_map_identifier(word);
-                }
+    void parser::read_char() {
+        /*
+            Grab each character and split each group
+            of characters on whitespace or on a few
+            special characters which have a specific
+            semantic meaning.
+        */
 
-                else {
-                    word += _c;
-                }
+        _c = _input.next();
+
+        if (!_skip) {
+
+            if (whitespace_char(_c) || _c == ',') {
+
+                process_word();
             }
+
             else if (_c == '#') {
-                handle_comment_operator(word);
+                handle_comment_operator();
+            }
+
+            else if (!_size && _c == '-') {
+                handle_unary_negation_operator();
+            }
+
+            else if (!_size && _c == '+') {
+                handle_unary_addition_operator();
+            }
+
+            else if (_c == '@') {
+                handle_pass_through_operator();
+            }
+
+            else if (_c == '\'') {
+                handle_numeric_identifier();
+            }
+
+            else if (_c == '"') {
+                handle_string_identifier();
+            }
+
+            else if (_c == '\\') {
+                handle_regex_identifier();
             }
-        }
 
-        process_word(word);
+            else if (_c == '`') {
+                handle_io_format_identifier();
+            }
 
-        word = ")";
+            else if (_c == '(' || _c == ')') {
+                handle_paren_expression_identifier();
+            }
 
-        process_word(word);
+            else if (_c == ':' || _c == ';') {
+                handle_colon_expression_identifier();
+            }
+
+            else if (_c == '[' || _c == ']') {
+                handle_list_identifier();
+            }
 
-        return _text;
+            else if (_c == '{' || _c == '}') {
+                handle_map_identifier();
+            }
+
+            else {
+                /*
+                    The characters of a word are always
+                    next to each other in the text, so
+                    a word is kept as its position and
+                    length.
+                */
+
+                if (!_size) {
+                    _word = position();
+                }
+
+                _size += 1;
+            }
+        }
+        else if (_c == '#') {
+            handle_comment_operator();
+        }
     }
 
     int parser::is_regex_escape_char(const char& c) {
@@ -247,19 +333,23 @@ namespace Olly {
         return false;
     }
 
-    void parser::process_word(std::string& word) {
+    void parser::process_word() {
         /*
             Check that we are not within a comment block.
             Else ensure we have a word to handle and place
             it on the back of the text queue.
         */
 
-        if (word != "") {
-            _text.push_back(word);
-            word.clear();
+        if (_size) {
+            push(TOKEN_KIND::word, source(_word, _size), _word);
+            _size = 0;
         }
     }
 
+    inline void parser::push(TOKEN_KIND kind, std::string_view text, size_type offset) {
+        _text.push_back(token{ kind, text, offset });
+    }
+
     void parser::handle_leading_whitespace() {
 
         while (_input.is()) {
@@ -277,7 +367,7 @@ namespace Olly {
         }
     }
 
-    void parser::handle_comment_operator(std::string& word) {
+    void parser::handle_comment_operator() {
         /*
                     A comment has probably been encountered.
                     '#'  comment to the end of the line.
@@ -285,7 +375,7 @@ namespace Olly {
                     '#!' Reserved to implement a preprocessor type system?
                 */
 
-        process_word(word);
+        process_word();
 
         if (_input.peek() == '#') {
             /*
@@ -314,242 +404,225 @@ namespace Olly {
         }
     }
 
-    void parser::handle_unary_negation_operator(std::string& word) {
+    void parser::handle_unary_negation_operator() {
+
+        size_type at = position();
 
         if (_input.peek() == '=') {
-            word = "-=";
-            process_word(word);
+            push(TOKEN_KIND::word, source(at, 2), at);
             _c = _input.next();
             _c = ' ';
         }
 
         else if (_input.peek() == '-') {
 
-            auto c = _input.next();
+            _input.next();
 
             if (_input.peek() == '>' || _input.peek() == '<') {
 
-                word = "";
-                word.push_back(_c);
-                word.push_back(c);
-                word.push_back(_input.next());
+                _input.next();
 
-                process_word(word);
+                push(TOKEN_KIND::word, source(at, 3), at);
                 _c = ' ';
             }
             else {
-                word = "neg";
-                process_word(word);
-
-                word = "neg";
-                process_word(word);
+                push(TOKEN_KIND::word, "neg", at);
+                push(TOKEN_KIND::word, "neg", at + 1);
             }
         }
 
         else if (_input.peek() != ' ') {
-            word = "neg";
-            process_word(word);
+            push(TOKEN_KIND::word, "neg", at);
         }
 
         else {
-            word = "-";
-            process_word(word);
+            push(TOKEN_KIND::word, source(at, 1), at);
         }
     }
 
-    void parser::handle_unary_addition_operator(std::string& word) {
+    void parser::handle_unary_addition_operator() {
+
+        size_type at = position();
 
         if (_input.peek() != ' ') {
-            word = "pos";
-            process_word(word);
+            push(TOKEN_KIND::word, "pos", at);
         }
         else {
-            word = "+";
-            process_word(word);
+            push(TOKEN_KIND::word, source(at, 1), at);
         }
     }
 
-    void parser::handle_pass_through_operator(std::string& word) {
+    void parser::handle_pass_through_operator() {
         /*
             We encountered a pass operator.
 
         */
-        process_word(word);
+        process_word();
 
-        word = "@";
-        process_word(word);
+        push(TOKEN_KIND::word, source(position(), 1), position());
     }
 
-    void parser::handle_numeric_identifier(std::string& word) {
+    void parser::handle_numeric_identifier() {
         /*
             A number was encountered.
         */
 
-        process_word(word);
+        process_word();
 
-        _text.push_back("\'");
-        _text.push_back(read_number());
-        _text.push_back("\'");
+        size_type at = _input.position();
+
+        push(TOKEN_KIND::number, read_number(), at);
     }
 
-    void parser::handle_string_identifier(std::string& word) {
+    void parser::handle_string_identifier() {
         /*
             A string identification was encountered.
             Process the string, and add it to _text
             so long as we are not in a comment block.
         */
 
-        process_word(word);
+        process_word();
+
+        size_type at = _input.position();
 
-        _text.push_back("\"");
-        _text.push_back(read_string());
-        _text.push_back("\"");
+        push(TOKEN_KIND::string, read_string(), at);
     }
 
-    void parser::handle_regex_identifier(std::string& word) {
+    void parser::handle_regex_identifier() {
         /*
             A regex identification was encountered.
             Process the regex, and add it to _text
             so long as we are not in a comment block.
         */
 
-        process_word(word);
+        process_word();
 
-        _text.push_back("\\");
-        _text.push_back(read_regex());
-        _text.push_back("\\");
+        size_type at = _input.position();
+
+        push(TOKEN_KIND::regex, read_regex(), at);
     }
 
-    void parser::handle_io_format_identifier(std::string& word) {
+    void parser::handle_io_format_identifier() {
         /*
             A format identification was encountered.
             Process the format, and add it to _text
             so long as we are not in a comment block.
         */
 
-        process_word(word);
+        process_word();
+
+        size_type at = _input.position();
 
-        _text.push_back("`");
-        _text.push_back(read_format());
-        _text.push_back("`");
+        push(TOKEN_KIND::format, read_format(), at);
     }
 
-    void parser::handle_paren_expression_identifier(std::string& word) {
+    void parser::handle_paren_expression_identifier() {
         /*
             An expression operator was encountered.
             Process the expression, and add it to _text
             so long as we are not in a comment block.
         */
 
-        process_word(word);
+        process_word();
 
-        _text.push_back(expression_op(_c));
+        push(expression_op(_c), source(position(), 1), position());
     }
 
-    void parser::handle_colon_expression_identifier(std::string& word) {
+    void parser::handle_colon_expression_identifier() {
         /*
             An expression operator was encountered.
             Process the expression, and add it to _text
             so long as we are not in a comment block.
+
+            A ':' or ';' is read as the '(' or ')'
+            it stands for.
         */
 
-        process_word(word);
+        process_word();
+
+        size_type at = position();
 
         if (_input.peek() == ':' && _c == ':') {
             _c = _input.next();
-            _text.push_back("::");
+            push(TOKEN_KIND::word, source(at, 2), at);
+            _c = ' ';
+        }
+        else if (expression_op(_c) == TOKEN_KIND::open_expression) {
+            push(TOKEN_KIND::open_expression, "(", at);
             _c = ' ';
         }
         else {
-            _text.push_back(expression_op(_c));
+            push(TOKEN_KIND::close_expression, ")", at);
             _c = ' ';
         }
     }
 
-    void parser::handle_list_identifier(std::string& word) {
+    void parser::handle_list_identifier() {
         /*
             A list operator was encountered.
             Process the list, and add it to _text
             so long as we are not in a comment block
         */
 
-        process_word(word);
+        process_word();
 
-        _text.push_back(list_op(_c));
+        push(list_op(_c), source(position(), 1), position());
 
         _c = ' ';
     }
 
-    void parser::handle_map_identifier(std::string& word) {
+    void parser::handle_map_identifier() {
         /*
             An map operator was encountered.
             Process the map, and add it to _text
             so long as we are not in a comment block
         */
 
-        process_word(word);
+        process_word();
 
-        if (_c == '{') {
-            word = "{";
-        }
-
-        else {
-            word = "}";
-        }
+        push(map_op(_c), source(position(), 1), position());
 
-        process_word(word);
         _c = ' ';
     }
 
-    std::string parser::read_format() {
+    std::string_view parser::read_format() {
         /*
             Read each character including
-            whitespace and form a word to
-            be used to define a format
+            whitespace up to the closing '`',
+            to be used to define a format
             map.
         */
 
-        std::string str;
-
-        char c;
+        size_type start = _input.position();
 
         while (_input.is()) {
 
-            c = _input.next();
-
-            if (c == '`') {
-                break;
-            }
-
-            else {
-                str += c;
+            if (_input.next() == '`') {
+                return source(start, position() - start);
             }
         }
 
-        if (str.empty()) {
-            return "";
-        }
-
-        return str;
+        return source(start, _input.position() - start);
     }
 
-    std::string parser::read_string() {
+    std::string_view parser::read_string() {
         /*
             Read each character including
-            whitespace and form a word to
-            be used to define a string of
+            whitespace up to the closing '"',
+            to be used to define a string of
             characters.
 
             When a '\' character is found
             check to see if it is used to
             define an escaped character.
-            If it is append the escaped
-            character to the string.
+            If it is skip the escaped
+            character, which is replaced
+            when the token is decoded.
         */
 
         bool escaped = false;
 
-        std::string str;
+        size_type start = _input.position();
 
         char c;
 
@@ -558,46 +631,6 @@ namespace Olly {
             c = _input.next();
 
             if (escaped) {
-
-                switch (c) {
-
-                case '\\':
-                    str += '\\';
-                    break;
-
-                case 'a':
-                    str += '\a';
-                    break;
-
-                case 'b':
-                    str += '\b';
-                    break;
-
-                case 'f':
-                    str += '\f';
-                    break;
-
-                case 'n':
-                    str += '\n';
-                    break;
-
-                case 'r':
-                    str += '\r';
-                    break;
-
-                case 't':
-                    str += '\t';
-                    break;
-
-                case 'v':
-                    str += '\v';
-                    break;
-
-                default:
-                    str += c;
-                    break;
-                }
-
                 escaped = false;
             }
             else if ((c == '\\') && (is_string_escape_char(_input.peek()))) {
@@ -605,66 +638,51 @@ namespace Olly {
                 escaped = true;
             }
             else if (c == '"') {
-                break;
-            }
-            else {
-                str += c;
+                return source(start, position() - start);
             }
         }
 
-        return str;
+        return source(start, _input.position() - start);
     }
 
-    std::string parser::read_number() {
+    std::string_view parser::read_number() {
         /*
             Read each character including
-            whitespace and form a word to
-            be used to define a string of
-            characters.
-
-            When a '\' character is found
-            check to see if it is used to
-            define an escaped character.
-            If it is append the escaped
-            character to the string.
+            whitespace up to the closing
+            quote, to be used to define
+            a number.
         */
 
-        std::string str;
-
-        char c;
+        size_type start = _input.position();
 
         while (_input.is()) {
 
-            c = _input.next();
-
-            if (c == '\'') {
-                break;
-            }
-            else {
-                str += c;
+            if (_input.next() == '\'') {
+                return source(start, position() - start);
             }
         }
 
-        return str;
+        return source(start, _input.position() - start);
     }
 
-    std::string parser::read_regex() {
+    std::string_view parser::read_regex() {
         /*
             Read each character including
-            whitespace and form a word to
-            be used to define a regex of
+            whitespace up to the closing '\',
+            to be used to define a regex of
             characters.
 
             When a '\' character is found
             check to see if it is used to
             define an escaped character.
-            If it is append the escaped
-            character to the regex.
+            If it is skip the escaped
+            character, which is replaced
+            when the token is decoded.
         */
 
         bool escaped = false;
 
-        std::string str;
+        size_type start = _input.position();
 
         char c;
 
@@ -673,66 +691,55 @@ namespace Olly {
             c = _input.next();
 
             if (escaped) {
-
-                if (c == '\\') {
-                    str += '\\';
-                }
-                else {
-                    str += c;
-                }
-
                 escaped = false;
             }
             else if ((c == '\\') && (is_string_escape_char(_input.peek()))) {
 
                 escaped = true;
             }
-            else if (c == '\\' && !escaped) {
-                break;
-            }
-            else {
-                str += c;
+            else if (c == '\\') {
+                return source(start, position() - start);
             }
         }
 
-        return str;
+        return source(start, _input.position() - start);
     }
 
-    std::string parser::list_op(const char& c) {
+    TOKEN_KIND parser::list_op(const char& c) {
         /*
             Validate which list operator is provided.
         */
         if (c == '[') {
 
-            return "[";
+            return TOKEN_KIND::open_list;
         }
 
-        return "]";
+        return TOKEN_KIND::close_list;
     }
 
-    std::string parser::map_op(const char& c) {
+    TOKEN_KIND parser::map_op(const char& c) {
         /*
             Validate which map operator is provided.
         */
         if (c == '{') {
 
-            return "{";
+            return TOKEN_KIND::open_map;
         }
 
-        return "}";
+        return TOKEN_KIND::close_map;
     }
 
-    std::string parser::expression_op(const char& c) {
+    TOKEN_KIND parser::expression_op(const char& c) {
         /*
             Validate which expression operator is provided.
         */
 
         if (c == '(' || c == ':') {
 
-            return "(";
+            return TOKEN_KIND::open_expression;
         }
 
-        return ")";
+        return TOKEN_KIND::close_expression;
     }
 
     void parser::skip_comment_line() {
@@ -764,17 +771,16 @@ namespace Olly {
         return false;
     }
 
-    inline std::string parser::pop_text() {
-
-        if (!_text.empty()) {
-
-            std::string word = _text.back();
-            _text.pop_back();
+    inline size_type parser::position() const {
+        /*
+            Return the position of the current character.
+        */
 
-            return word;
-        }
+        return _input.position() - 1;
+    }
 
-        return "";
+    inline std::string_view parser::source(size_type offset, size_type size) const {
+        return _input.view().substr(offset, size);
     }
     
 } // end Olly
\ No newline at end of file
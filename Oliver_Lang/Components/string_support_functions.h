@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Olly {
@@ -33,6 +34,9 @@ namespace Olly {
     std::string to_lower(std::string str);                                              // Set all text in a std::string to lower case.
     std::string to_upper(std::string str);                                              // Set all text in a std::string to upper case.
 
+    void assign_lower(std::string& out, std::string_view str);                          // Set 'out' to the text in lower case, reusing its memory.
+    void assign_upper(std::string& out, std::string_view str);                          // Set 'out' to the text in upper case, reusing its memory.
+
     void ltrim(std::string& s);                                                         // Mutable remove left white space.
     void rtrim(std::string& s);                                                         // Mutable remove right white space.
     void lrtrim(std::string& s);                                                        // Mutable remove left and right white space.
@@ -67,6 +71,20 @@ namespace Olly {
         return str;
     }
 
+    inline void assign_lower(std::string& out, std::string_view str) {
+
+        out.assign(str);
+
+        std::transform(out.begin(), out.end(), out.begin(), ::tolower);
+    }
+
+    inline void assign_upper(std::string& out, std::string_view str) {
+
+        out.assign(str);
+
+        std::transform(out.begin(), out.end(), out.begin(), ::toupper);
+    }
+
     inline void ltrim(std::string& s) {
         if (s.empty()) {
             return;
@@ -22,175 +22,167 @@
 /********************************************************************************************/
 
 #include <algorithm>
-#include <fstream>
-#include <mutex>
-#include <sstream>
 #include <string>
+#include <string_view>
 
+#include "mapped_file.h"
 #include "string_support_functions.h"
 
 namespace Olly {
 
-	/********************************************************************************************/
-	//
-	//                              'text_reader' class definition
-	//
-	//        The text_reader class opens a file and then passes each individual character
-	//        to the text_reader for evaluation.  If a valid file is not opened then the string
-	//        itself is iterated over for reading.  
-	//
-	/********************************************************************************************/
+    /********************************************************************************************/
+    //
+    //                              'text_reader' class definition
+    //
+    //        The text_reader class opens a file and then passes each individual character
+    //        to the text_reader for evaluation.  If a valid file is not opened then the string
+    //        itself is iterated over for reading.
+    //
+    //        A file is mapped in to memory, and read in place.  Either way the text is
+    //        viewed as one string, so that a word may be viewed rather than copied.
+    //        A text_reader is read by a single thread.
+    //
+    /********************************************************************************************/
 
-	class text_reader {
+    class text_reader {
 
-		char					_c;
-		std::fstream			_input;
-		bool   					_is_file;
-		std::stringstream		_stream;
-		std::recursive_mutex	_mutex;
+        std::string         _text;      // The text, when not a file.
+        mapped_file         _file;
+        bool                _is_file;
+        std::string_view    _view;      // The text being read.
+        std::size_t         _pos;       // The position of the current character.
 
-	public:
+    public:
 
-		text_reader(const std::string& inp);
-		virtual ~text_reader();
+        text_reader(const std::string& inp);
+        virtual ~text_reader();
 
-		char next();
-		char peek();
+        char next();
+        char peek() const;
 
-		std::string get_line();
+        std::string get_line();
 
-		bool is();
+        bool is() const;
 
-		bool is_file();
+        bool is_file() const;
 
-	private:
-		text_reader();
-		text_reader(const text_reader& obj) = delete;
-	};
+        std::size_t position() const;
+        std::string_view view() const;
 
-	/********************************************************************************************/
-	//
-	//   Text reader implimentation.
-	//
-	/********************************************************************************************/
+    private:
+        text_reader();
+        text_reader(const text_reader& obj) = delete;
+    };
 
+    /********************************************************************************************/
+    //
+    //   Text reader implimentation.
+    //
+    /********************************************************************************************/
 
-	text_reader::text_reader() : _c('\0'), _input(), _is_file(false), _stream(), _mutex() {
-        }
-
-        text_reader::text_reader(const std::string& input_code) : _c('\0'), _input(), _is_file(true), _stream(), _mutex() {
-            /*
-                Open a file 'file_name' and retrieve its first character
-                Setting the value of the character to '_c'.  So long as
-                the file is not empty.
-            */
-            std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-            _input = std::fstream(input_code, std::fstream::in);
+    text_reader::text_reader() : _text(), _file(), _is_file(false), _view(), _pos(0) {
+    }
 
-            if (_input.is_open() && _input.good() && !_input.eof()) {
+    text_reader::text_reader(const std::string& input_code) : _text(), _file(), _is_file(true), _view(), _pos(0) {
+        /*
+            Map the file 'input_code', so long as it is
+            a file which can be read.
+        */
 
-                _c = _input.get();
-            }
-            else {
-                /*
-                    Not a file, so send the text to a stream to be
-                    treated just like a file.
-                */
-                _is_file = false;
-                _stream << input_code;
+        if (_file.open(input_code)) {
 
-                _c = _stream.get();
-            }
+            _view = _file.view();
         }
-
-        text_reader::~text_reader() {
-            _input.close();
-        }
-
-        char text_reader::next() {
+        else {
             /*
-                As long as the file is not at the end of the file,
-                return the current value of '_c' and set the next
-                value of '_c'.  Return a null character if the
-                file is eof.
+                Not a file, so read the text itself just
+                like a file.
             */
+            _is_file = false;
+            _text    = input_code;
 
-            if (_is_file) {
-                std::lock_guard<std::recursive_mutex> lock(_mutex);
-
-                char t = _c;
-
-                if (is()) {
-                    _input >> std::noskipws >> _c;
-                }
-
-                return t;
-            }
+            _view = _text;
+        }
+    }
 
+    text_reader::~text_reader() {
+    }
 
-            if (is()) {
+    inline char text_reader::next() {
+        /*
+            As long as the text is not at its end, return
+            the current character and move to the next.
+            Return a null character at the end.
+        */
 
-                char t = _c;
+        if (_pos < _view.size()) {
+            return _view[_pos++];
+        }
 
-                _stream >> std::noskipws >> _c;
+        return '\0';
+    }
 
-                return t;
-            }
+    inline char text_reader::peek() const {
+        /*
+            Return the current character, or a null
+            character at the end.
+        */
 
-            return '\0';
+        if (_pos < _view.size()) {
+            return _view[_pos];
         }
 
-        char text_reader::peek() {
-            /*
-                Return the current value of '_c'.
-            */
-            return _c;
-        }
+        return '\0';
+    }
 
-        bool text_reader::is() {
-            /*
-                Return true if the file is not eof
-                and in good condition.
-            */
+    inline bool text_reader::is() const {
+        /*
+            Return true if the text is not at its end.
+        */
 
-            if (_is_file) {
-                return (_input.is_open() && _input.good() && !_input.eof());
-            }
-            return (!_stream.eof() && _stream.good());
-        }
+        return _pos < _view.size();
+    }
 
-        bool text_reader::is_file() {
-            /*
-                Return true if the file is not eof
-                and in good condition.
-            */
+    inline bool text_reader::is_file() const {
+        /*
+            Return true if the text is read from a file.
+        */
 
-            return _is_file;
-        }
+        return _is_file;
+    }
 
-        std::string text_reader::get_line() {
+    inline std::size_t text_reader::position() const {
+        return _pos;
+    }
 
-            if (_is_file) {
-                std::lock_guard<std::recursive_mutex> lock(_mutex);
+    inline std::string_view text_reader::view() const {
+        return _view;
+    }
 
-                if (is()) {
+    inline std::string text_reader::get_line() {
+        /*
+            Return the rest of the current line, trimmed,
+            and move to the start of the next.
+        */
 
-                    std::string line;
+        if (!is()) {
+            return "";
+        }
+
+        std::size_t end = _view.find('\n', _pos);
 
-                    std::getline(_input, line);
+        if (end == std::string_view::npos) {
+            end = _view.size();
+        }
 
-                    lrtrim(line);
+        std::string line(_view.substr(_pos, end - _pos));
 
-                    if (line.empty()) {
-                        return "";
-                    }
+        _pos = (end < _view.size()) ? end + 1 : end;
 
-                    return line;
-                }
-            }
+        lrtrim(line);
 
-            return "";
-        }
+        return line;
+    }
 
-} // end Olly
\ No newline at end of file
+} // end Olly
@@ -0,0 +1,193 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Compiler/Data_Types/base_configuration/system_fundamentals.h"
+
+namespace Olly {
+
+    /********************************************************************************************/
+    //
+    //                                'token' definition
+    //
+    //        A token is a word of the source, as split by the parser.  Its text views
+    //        the source itself, so tokens are only valid while the parser which read
+    //        them is.  Words the parser makes up, such as 'neg' for a leading '-',
+    //        view a constant string instead.
+    //
+    //        The text of a literal is the text between its quotes, as written.  The
+    //        escapes of a string or regex are only replaced when it is decoded.
+    //
+    /********************************************************************************************/
+
+    enum class TOKEN_KIND {
+        word,
+        number,             // 'text'
+        string,             // "text"
+        regex,              // A regex, between '\' characters.
+        format,             // `text`
+        open_expression,    // ( or :
+        close_expression,   // ) or ;
+        open_list,          // [
+        close_list,         // ]
+        open_map,           // {
+        close_map           // }
+    };
+
+    struct token {
+        TOKEN_KIND          kind;
+        std::string_view    text;
+        size_type           offset;     // The position of the text in the source.
+    };
+
+    typedef     std::vector<token>      token_list;
+
+    /********************************************************************************************/
+    //
+    //                              'token_source' class definition
+    //
+    //        A token_source gives the tokens of a program one at a time, so that they
+    //        may be compiled as they are read rather than gathered first.
+    //
+    /********************************************************************************************/
+
+    class token_source {
+    public:
+
+        virtual ~token_source() {
+        }
+
+        virtual bool_type next(token& t) = 0;     // Set 't' to the next token, or return false at the end.
+    };
+
+    str_type decode(const token& t);
+    str_type spelling(const token& t);
+
+    /********************************************************************************************/
+    //
+    //   token implimentation.
+    //
+    /********************************************************************************************/
+
+    inline str_type decode(const token& t) {
+        /*
+            Return the text of a token with its escapes
+            replaced.  A string's escapes name control
+            characters, and a regex's only keep the
+            escaped character.
+        */
+
+        if (t.kind != TOKEN_KIND::string && t.kind != TOKEN_KIND::regex) {
+            return str_type(t.text);
+        }
+
+        static const std::string_view ESCAPE_CHARS = "\'\"\\abfnrtv";
+
+        str_type str;
+
+        str.reserve(t.text.size());
+
+        for (size_type i = 0; i < t.text.size(); ++i) {
+
+            char c = t.text[i];
+
+            if (c != '\\' || i + 1 == t.text.size() || ESCAPE_CHARS.find(t.text[i + 1]) == std::string_view::npos) {
+                str += c;
+                continue;
+            }
+
+            c = t.text[++i];
+
+            if (t.kind == TOKEN_KIND::regex) {
+                str += c;
+                continue;
+            }
+
+            switch (c) {
+
+            case 'a':
+                str += '\a';
+                break;
+
+            case 'b':
+                str += '\b';
+                break;
+
+            case 'f':
+                str += '\f';
+                break;
+
+            case 'n':
+                str += '\n';
+                break;
+
+            case 'r':
+                str += '\r';
+                break;
+
+            case 't':
+                str += '\t';
+                break;
+
+            case 'v':
+                str += '\v';
+                break;
+
+            default:
+                str += c;
+                break;
+            }
+        }
+
+        return str;
+    }
+
+    inline str_type spelling(const token& t) {
+        /*
+            Return a token as it is written, with
+            the quotes of a literal.
+        */
+
+        switch (t.kind) {
+
+        case TOKEN_KIND::number:
+            return "\'" + str_type(t.text) + "\'";
+
+        case TOKEN_KIND::string:
+            return "\"" + str_type(t.text) + "\"";
+
+        case TOKEN_KIND::regex:
+            return "\\" + str_type(t.text) + "\\";
+
+        case TOKEN_KIND::format:
+            return "`" + str_type(t.text) + "`";
+
+        default:
+            return str_type(t.text);
+        }
+    }
+
+} // end Olly
@@ -0,0 +1,201 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "token.h"
+
+namespace Olly {
+
+    /********************************************************************************************/
+    //
+    //                              'token_pipe' class definition
+    //
+    //        The token_pipe class reads the tokens of another source on a thread of
+    //        its own, so that a program is read while it is being compiled.  Tokens
+    //        are passed over in batches, so the threads seldom meet, and no more than
+    //        DEPTH batches are waiting at once, so reading never runs far ahead.
+    //
+    //        The source is only read by the pipe's thread, and must outlive the pipe.
+    //        The pipe itself is read by a single thread.
+    //
+    /********************************************************************************************/
+
+    class token_pipe : public token_source {
+
+        token_source&               _source;
+        token_list                  _batch;     // The batch being taken from.
+        size_type                   _taken;
+        std::deque<token_list>      _queue;     // The batches read and not yet taken.
+        std::vector<token_list>     _spare;     // Batches taken, kept to be filled again.
+        bool_type                   _done;      // The source has no more tokens.
+        bool_type                   _stop;      // The pipe is closing.
+        std::mutex                  _mutex;
+        std::condition_variable     _ready;     // A batch was queued, or the source is done.
+        std::condition_variable     _space;     // A batch was taken.
+        std::thread                 _reader;
+
+    public:
+
+        static const size_type BATCH;
+        static const size_type DEPTH;
+
+        token_pipe(token_source& source);
+        virtual ~token_pipe();
+
+        bool_type next(token& t) override;
+
+    private:
+
+        token_pipe() = delete;
+        token_pipe(const token_pipe& obj) = delete;
+
+        void read();
+        bool_type publish(token_list& batch);
+    };
+
+    /********************************************************************************************/
+    //
+    //   token_pipe implimentation.
+    //
+    /********************************************************************************************/
+
+    const size_type token_pipe::BATCH = 1024;   // Tokens passed over at once.
+    const size_type token_pipe::DEPTH = 4;      // Batches waiting at most.
+
+    token_pipe::token_pipe(token_source& source) : _source(source), _batch(), _taken(0), _queue(), _spare(), _done(false), _stop(false), _mutex(), _ready(), _space(), _reader() {
+        _reader = std::thread(&token_pipe::read, this);
+    }
+
+    token_pipe::~token_pipe() {
+        /*
+            Stop the reader, should the pipe be closed
+            before every token has been taken.
+        */
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+
+        _space.notify_all();
+
+        _reader.join();
+    }
+
+    inline bool_type token_pipe::next(token& t) {
+
+        if (_taken == _batch.size()) {
+
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            if (_batch.capacity()) {
+                _batch.clear();
+                _spare.push_back(std::move(_batch));
+            }
+
+            _ready.wait(lock, [this] { return !_queue.empty() || _done; });
+
+            if (_queue.empty()) {
+                _batch = token_list();
+                _taken = 0;
+                return false;
+            }
+
+            _batch = std::move(_queue.front());
+            _queue.pop_front();
+            _taken = 0;
+
+            lock.unlock();
+            _space.notify_one();
+        }
+
+        t = _batch[_taken++];
+
+        return true;
+    }
+
+    inline void token_pipe::read() {
+
+        token_list batch;
+        batch.reserve(BATCH);
+
+        token t;
+
+        while (_source.next(t)) {
+
+            batch.push_back(t);
+
+            if (batch.size() == BATCH && !publish(batch)) {
+                return;
+            }
+        }
+
+        if (!batch.empty()) {
+            publish(batch);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _done = true;
+        }
+
+        _ready.notify_one();
+    }
+
+    inline bool_type token_pipe::publish(token_list& batch) {
+        /*
+            Queue a batch once there is space for it, and
+            start the next batch in a spare one.  Return
+            false if the pipe is closing.
+        */
+
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        _space.wait(lock, [this] { return _queue.size() < DEPTH || _stop; });
+
+        if (_stop) {
+            return false;
+        }
+
+        _queue.push_back(std::move(batch));
+
+        if (!_spare.empty()) {
+            batch = std::move(_spare.back());
+            _spare.pop_back();
+        }
+        else {
+            batch = token_list();
+            batch.reserve(BATCH);
+        }
+
+        lock.unlock();
+        _ready.notify_one();
+
+        return true;
+    }
+
+} // end Olly
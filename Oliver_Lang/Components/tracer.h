@@ -0,0 +1,273 @@
+#pragma once
+
+/********************************************************************************************/
+//
+//          Copyright 2021 Max J. Martin
+//
+//          This file is part of Oliver.
+//
+//          Oliver is free software : you can redistribute it and / or modify
+//          it under the terms of the GNU General Public License as published by
+//          the Free Software Foundation, either version 3 of the License, or
+//          (at your option) any later version.
+//
+//          Oliver is distributed in the hope that it will be useful,
+//          but WITHOUT ANY WARRANTY; without even the implied warranty of
+//          MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//          GNU General Public License for more details.
+//
+//          You should have received a copy of the GNU General Public License
+//          along with Oliver.If not, see < https://www.gnu.org/licenses/>.
+//
+/********************************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+#include "Compiler/Data_Types/base_configuration/system_fundamentals.h"
+
+namespace Olly {
+
+    /********************************************************************************************/
+    //
+    //                                'tracer' class definition
+    //
+    //        The tracer class records timed spans of work, such as parsing, compiling
+    //        and each evaluation, for the Chrome trace viewer.  Each thread writes
+    //        its spans to a ring buffer of its own, keeping the newest once full, so
+    //        recording takes no lock.  Nothing is recorded until 'enable' is called.
+    //
+    //        The buffers are read by 'json', which should be called once the
+    //        threads being traced are idle.
+    //
+    /********************************************************************************************/
+
+    class tracer {
+    public:
+
+        typedef     std::uint64_t   tick_type;      // Nanoseconds since the tracer was enabled.
+
+        static const     size_type DEFAULT_CAPACITY;
+        static constexpr size_type NAME_SIZE = 48;
+
+        class span {
+            /*
+                Record the lifetime of the span, when tracing.
+            */
+
+            const char* _category;
+            const char* _name;
+            tick_type   _start;
+            bool_type   _on;
+
+        public:
+
+            span(const char* category, const char* name);
+            ~span();
+        };
+
+        static void enable(size_type capacity, bool_type calls);
+        static bool_type enabled();
+        static bool_type tracing_calls();
+
+        static tick_type now();
+
+        static void complete(const char* category, const char* name, tick_type start, tick_type stop);
+
+        static str_type json();
+
+    private:
+
+        struct event {
+            char            name[NAME_SIZE];
+            const char*     category;
+            tick_type       start;
+            tick_type       duration;
+        };
+
+        struct ring {
+            std::vector<event>      events;
+            std::atomic<size_type>  written;    // Every event written, including those overwritten.
+            size_type               tid;
+        };
+
+        static std::atomic<bool_type>               _enabled;
+        static std::atomic<bool_type>               _calls;
+        static size_type                            _capacity;
+        static std::chrono::steady_clock::time_point _epoch;
+
+        static std::vector<std::unique_ptr<ring>>   _rings;     // Kept after their threads end, to be read.
+        static std::mutex                           _mutex;
+
+        static thread_local ring*                   _ring;
+
+        static ring& local();
+        static void escape(stream_type& out, const char* text);
+    };
+
+
+
+    const size_type tracer::DEFAULT_CAPACITY = 1 << 16;
+
+    std::atomic<bool_type>                  tracer::_enabled(false);
+    std::atomic<bool_type>                  tracer::_calls(false);
+    size_type                               tracer::_capacity = tracer::DEFAULT_CAPACITY;
+    std::chrono::steady_clock::time_point   tracer::_epoch;
+
+    std::vector<std::unique_ptr<tracer::ring>>  tracer::_rings;
+    std::mutex                                  tracer::_mutex;
+
+    thread_local tracer::ring*                  tracer::_ring = nullptr;
+
+    tracer::span::span(const char* category, const char* name) : _category(category), _name(name), _start(0), _on(enabled()) {
+
+        if (_on) {
+            _start = now();
+        }
+    }
+
+    tracer::span::~span() {
+
+        if (_on) {
+            complete(_category, _name, _start, now());
+        }
+    }
+
+    inline void tracer::enable(size_type capacity, bool_type calls) {
+        /*
+            Start tracing, with room for 'capacity' spans on each
+            thread.  With 'calls', each lambda call is traced too.
+        */
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _capacity = std::max<size_type>(capacity, 1);
+        _epoch    = std::chrono::steady_clock::now();
+
+        _calls.store(calls, std::memory_order_relaxed);
+        _enabled.store(true, std::memory_order_release);
+    }
+
+    inline bool_type tracer::enabled() {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    inline bool_type tracer::tracing_calls() {
+        return _calls.load(std::memory_order_relaxed);
+    }
+
+    inline tracer::tick_type tracer::now() {
+        return static_cast<tick_type>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _epoch).count());
+    }
+
+    inline tracer::ring& tracer::local() {
+        /*
+            A thread's ring is made the first time it records.
+        */
+
+        if (!_ring) {
+
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            auto r = std::make_unique<ring>();
+
+            r->events.resize(_capacity);
+            r->written.store(0, std::memory_order_relaxed);
+            r->tid = _rings.size() + 1;
+
+            _ring = r.get();
+
+            _rings.push_back(std::move(r));
+        }
+
+        return *_ring;
+    }
+
+    inline void tracer::complete(const char* category, const char* name, tick_type start, tick_type stop) {
+
+        ring& r = local();
+
+        size_type n = r.written.load(std::memory_order_relaxed);
+
+        event& e = r.events[n % r.events.size()];
+
+        std::strncpy(e.name, name, NAME_SIZE - 1);
+        e.name[NAME_SIZE - 1] = '\0';
+
+        e.category = category;
+        e.start    = start;
+        e.duration = stop > start ? stop - start : 0;
+
+        r.written.store(n + 1, std::memory_order_release);
+    }
+
+    inline str_type tracer::json() {
+        /*
+            The spans recorded, as complete ('X') events of the
+            trace event format, with a name for each thread.
+            Times are in microseconds.
+        */
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        stream_type out;
+
+        out << std::fixed << std::setprecision(3);
+
+        out << "{\"traceEvents\":[";
+
+        bool_type first = true;
+
+        for (const auto& r : _rings) {
+
+            if (!first) {
+                out << ",";
+            }
+
+            first = false;
+
+            out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << r->tid
+                << ",\"args\":{\"name\":\"thread " << r->tid << "\"}}";
+
+            size_type n    = r->written.load(std::memory_order_acquire);
+            size_type size = r->events.size();
+
+            for (size_type i = (n > size ? n - size : 0); i < n; ++i) {
+
+                const event& e = r->events[i % size];
+
+                out << ",\n{\"name\":\"";
+                escape(out, e.name);
+                out << "\",\"cat\":\"" << e.category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << r->tid
+                    << ",\"ts\":" << static_cast<double>(e.start) / 1000
+                    << ",\"dur\":" << static_cast<double>(e.duration) / 1000 << "}";
+            }
+        }
+
+        out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+        return out.str();
+    }
+
+    inline void tracer::escape(stream_type& out, const char* text) {
+
+        for (const char* c = text; *c; ++c) {
+
+            if (*c == '"' || *c == '\\') {
+                out << '\\' << *c;
+            }
+            else if (static_cast<unsigned char>(*c) < 0x20) {
+                out << ' ';
+            }
+            else {
+                out << *c;
+            }
+        }
+    }
+
+} // end Olly
@@ -26,9 +26,12 @@
 #include "Components/Compiler/Data_Types/base_configuration/system_fundamentals.h"
 #include "Components/text_reader.h"
 #include "Components/parser.h"
+#include "Components/token_pipe.h"
 #include "Components/file_writer.h"
 #include "Components/Compiler/compiler.h"
+#include "Components/Compiler/optimizer.h"
 #include "Components/Evaluator/evaluator.h"
+#include "Components/Evaluator/evaluator_pool.h"
 
 namespace Olly {
 } // end Olly
\ No newline at end of file